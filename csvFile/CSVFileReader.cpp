@@ -1,14 +1,28 @@
 #include "CSVFileReader.h"
+#include "CSVNumber.h"
+#include "utils/fileUtils/GzipStreamBuf.h"
+#include "utils/fileUtils/MappedFile.h"
+#include "utils/serialization/BinarySerializer.h"
+#include <chrono>
 #include <fstream>
 #include <sstream>
-#include <algorithm>
-#include <cctype>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t ROW_INDEX_MAGIC = 0x58444952;   // "RIDX"
+constexpr uint32_t ROW_INDEX_VERSION = 1;
+const char* const ROW_INDEX_EXTENSION = ".rowidx";
+
+}
 
 CSVFileReader::CSVFileReader(const std::string& filename, char commentChar)
     : m_filename(filename), m_commentChar(commentChar)
 {
-    // Open the file for reading
-    m_file.open(filename, std::ios::in);
+    // Open the file for reading; a ".gz" file is inflated as it is read
+    m_pFileBuffer = GzipStreamBuf::openFile(filename, std::ios::in);
+    m_file.rdbuf(m_pFileBuffer.get());
     
     if (isValid()) {
         // Read headers if file is valid
@@ -21,9 +35,8 @@ CSVFileReader::CSVFileReader(const std::string& filename, char commentChar)
 CSVFileReader::~CSVFileReader()
 {
     // Ensure file is properly closed
-    if (m_file.is_open()) {
-        m_file.close();
-    }
+    m_file.rdbuf(nullptr);
+    m_pFileBuffer.reset();
 }
 
 const std::vector<std::string>& CSVFileReader::getHeaders() const
@@ -108,9 +121,97 @@ size_t CSVFileReader::readAllRowsAsNumbers(std::vector<std::vector<double>>& row
     return count;
 }
 
+bool CSVFileReader::readNewRow(std::vector<std::string>& values, uint32_t timeoutMs)
+{
+    values.clear();
+
+    if (m_pFileBuffer == nullptr || m_file.bad()) {
+        return false;
+    }
+    // Watch before looking at the file so that no change after the check is missed
+    if (timeoutMs > 0 && !m_pWatcher) {
+        m_pWatcher = std::make_unique<FileChangeWatcher>(m_filename);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        while (readCompleteLine(m_line)) {
+            if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();   // CRLF tolerance
+            if (m_line.empty() || (m_commentChar != '\0' && m_line[0] == m_commentChar))
+                continue;   // skip blank / comment lines
+            if (m_headers.empty()) {
+                // The file was opened before its header line was written
+                parseLine(m_line, m_headers);
+                m_dataStartPos = m_file.tellg();
+                continue;
+            }
+            bool success = parseLine(m_line, values);
+            if (success) {
+                m_currentRow++;
+            }
+            return success;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+        m_pWatcher->wait((uint32_t)remaining.count() + 1);
+    }
+}
+
+bool CSVFileReader::setProjection(const std::vector<std::string>& columnNames)
+{
+    return CSVRowParser::buildProjection(m_headers, columnNames, m_projection);
+}
+
+bool CSVFileReader::readProjectedRow(std::vector<std::string_view>& fields)
+{
+    fields.clear();
+
+    if (!isValid() || isEndOfFile()) {
+        return false;
+    }
+
+    while (std::getline(m_file, m_line)) {
+        if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();   // CRLF tolerance
+        if (m_line.empty() || (m_commentChar != '\0' && m_line[0] == m_commentChar))
+            continue;   // skip blank / comment lines
+
+        const char* pLine = m_line.data();
+        m_rowParser.parseProjectedRow(pLine, pLine + m_line.size(), m_projection, fields);
+        m_currentRow++;
+        return true;
+    }
+    return false;
+}
+
+size_t CSVFileReader::readColumns(const std::vector<std::string>& columnNames, std::vector<std::vector<double>>& columns)
+{
+    columns.assign(columnNames.size(), std::vector<double>());
+    if (!setProjection(columnNames)) {
+        return 0;
+    }
+
+    std::vector<std::string_view> fields;
+    size_t count = 0;
+    while (readProjectedRow(fields)) {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            double value;
+            if (CSVNumber::parse(fields[i], value) != CSVNumber::Status::Ok) {
+                value = std::numeric_limits<double>::quiet_NaN();
+            }
+            columns[i].push_back(value);
+        }
+        count++;
+    }
+    return count;
+}
+
 bool CSVFileReader::isValid() const
 {
-    return m_file.is_open() && m_file.good();
+    return m_pFileBuffer != nullptr && m_file.good();
 }
 
 bool CSVFileReader::isEndOfFile() const
@@ -139,6 +240,8 @@ size_t CSVFileReader::getColumnCount() const
 void CSVFileReader::setDelimiter(char delimiter)
 {
     m_delimiter = delimiter;
+    m_rowParser.setDelimiter(delimiter);
+    m_index.setDelimiter(delimiter);
 }
 
 bool CSVFileReader::parseLine(const std::string& line, std::vector<std::string>& fields)
@@ -149,23 +252,53 @@ bool CSVFileReader::parseLine(const std::string& line, std::vector<std::string>&
         return true; // Empty line is valid, just no fields
     }
     
+    // Field boundaries (delimiters outside quotes) come from the vectorized index;
+    // only fields that contain quotes need the per-character pass
+    const char* pLine = line.data();
+    m_index.scanRecord(pLine, pLine + line.size(), m_separators);
+    
+    const char* pField = pLine;
+    for (uint32_t separator : m_separators) {
+        const char* pFieldEnd = pLine + separator;
+        size_t length = pFieldEnd - pField;
+        if (memchr(pField, '"', length) == nullptr) {
+            fields.emplace_back(pField, length);
+        } else {
+            fields.push_back(unescapeField(unquoteField(pField, length)));
+        }
+        pField = pFieldEnd + 1;
+    }
+    
+    return true;
+}
+
+bool CSVFileReader::readCompleteLine(std::string& line)
+{
+    // EOF flags are sticky; clearing them lets the stream see appended data
+    m_file.clear();
+    std::streampos lineStart = m_file.tellg();
+    if (std::getline(m_file, line) && !m_file.eof()) {
+        return true;
+    }
+
+    // Nothing new, or a last line without its newline yet: retry from its start
+    m_file.clear();
+    m_file.seekg(lineStart);
+    return false;
+}
+
+std::string CSVFileReader::unquoteField(const char* pField, size_t length) const
+{
     std::string field;
     bool inQuotes = false;
-    bool escapeNext = false;
     
-    for (size_t i = 0; i < line.length(); ++i) {
-        char c = line[i];
-        
-        if (escapeNext) {
-            field += c;
-            escapeNext = false;
-            continue;
-        }
+    for (size_t i = 0; i < length; ++i) {
+        char c = pField[i];
         
         if (c == '"') {
             if (inQuotes) {
                 // Check if this is an escaped quote
-                if (i + 1 < line.length() && line[i + 1] == '"') {
+                if (i + 1 < length && pField[i + 1] == '"') {
                     field += '"';
                     ++i; // Skip the next quote
                 } else {
@@ -176,19 +309,12 @@ bool CSVFileReader::parseLine(const std::string& line, std::vector<std::string>&
                 // Start of quoted field
                 inQuotes = true;
             }
-        } else if (c == m_delimiter && !inQuotes) {
-            // End of field
-            fields.push_back(unescapeField(field));
-            field.clear();
         } else {
             field += c;
         }
     }
     
-    // Add the last field
-    fields.push_back(unescapeField(field));
-    
-    return true;
+    return field;
 }
 
 std::string CSVFileReader::unescapeField(const std::string& field) const
@@ -220,8 +346,10 @@ bool CSVFileReader::readHeaders()
         return false;
     }
     
+    // Only a complete line is a header: a file still being written may end
+    // inside it, and readNewRow() picks the header up once it is finished
     std::string line;
-    while (std::getline(m_file, line)) {
+    while (readCompleteLine(line)) {
         if (!line.empty() && line.back() == '\r') line.pop_back();   // CRLF tolerance
         if (line.empty() || (m_commentChar != '\0' && line[0] == m_commentChar))
             continue;   // skip blank / comment lines before the header
@@ -232,32 +360,160 @@ bool CSVFileReader::readHeaders()
 
 bool CSVFileReader::stringToDouble(const std::string& str, double& value) const
 {
-    if (str.empty()) {
-        value = 0.0;
+    // Empty and whitespace-only fields read as 0
+    CSVNumber::Status status = CSVNumber::parse(str, value);
+    return status == CSVNumber::Status::Ok || status == CSVNumber::Status::Empty;
+}
+
+bool CSVFileReader::buildRowIndex(bool bPersist)
+{
+    if (m_bRowIndexBuilt) {
         return true;
     }
+    if (m_pFileBuffer == nullptr || m_dataStartPos == std::streampos(-1)) {
+        return false;
+    }
     
-    // Trim whitespace
-    std::string trimmed = str;
-    trimmed.erase(trimmed.begin(), std::find_if(trimmed.begin(), trimmed.end(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }));
-    trimmed.erase(std::find_if(trimmed.rbegin(), trimmed.rend(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }).base(), trimmed.end());
-    
-    if (trimmed.empty()) {
-        value = 0.0;
+    FileStamp stamp;
+    std::string indexPath = getRowIndexPath(m_filename);
+    bool hasStamp = bPersist && FileStamp::read(m_filename, stamp);
+    if (hasStamp && loadRowIndex(indexPath, stamp)) {
+        m_bRowIndexBuilt = true;
         return true;
     }
     
-    try {
-        size_t processed = 0;
-        value = std::stod(trimmed, &processed);
-        
-        // Check if entire string was processed
-        return processed == trimmed.length();
-    } catch (const std::exception&) {
+    if (!scanRowOffsets()) {
+        return false;
+    }
+    m_bRowIndexBuilt = true;
+    if (hasStamp) {
+        saveRowIndex(indexPath, stamp);
+    }
+    return true;
+}
+
+bool CSVFileReader::seekRow(size_t n)
+{
+    if (!buildRowIndex() || n > m_rowOffsets.size()) {
         return false;
     }
-}
\ No newline at end of file
+    
+    m_file.clear();
+    if (n == m_rowOffsets.size()) {
+        m_file.seekg(0, std::ios::end);
+    } else {
+        m_file.seekg(std::streamoff(m_rowOffsets[n]));
+    }
+    m_currentRow = n;
+    
+    return m_file.good();
+}
+
+size_t CSVFileReader::readRows(size_t first, size_t count, std::vector<std::vector<std::string>>& rows)
+{
+    rows.clear();
+    if (!seekRow(first)) {
+        return 0;
+    }
+    
+    std::vector<std::string> rowData;
+    while (rows.size() < count && readRow(rowData)) {
+        rows.push_back(rowData);
+    }
+    
+    return rows.size();
+}
+
+std::string CSVFileReader::getRowIndexPath(const std::string& filename)
+{
+    return filename + ROW_INDEX_EXTENSION;
+}
+
+bool CSVFileReader::scanRowOffsets()
+{
+    MappedFile mapping;
+    if (!mapping.open(m_filename)) {
+        return false;
+    }
+    
+    // Same line rules as readRow(): a line is a data row unless it is empty
+    // (after CRLF tolerance) or starts with the comment char
+    const char* pData = mapping.data();
+    size_t size = mapping.size();
+    size_t lineStart = (size_t)std::streamoff(m_dataStartPos);
+    m_rowOffsets.clear();
+    while (lineStart < size) {
+        const char* pNewline = (const char*)memchr(pData + lineStart, '\n', size - lineStart);
+        size_t lineEnd = pNewline != nullptr ? (size_t)(pNewline - pData) : size;
+        size_t length = lineEnd - lineStart;
+        if (length > 0 && pData[lineEnd - 1] == '\r') {
+            length--;
+        }
+        if (length > 0 && (m_commentChar == '\0' || pData[lineStart] != m_commentChar)) {
+            m_rowOffsets.push_back(lineStart);
+        }
+        lineStart = lineEnd + 1;
+    }
+    
+    return true;
+}
+
+bool CSVFileReader::loadRowIndex(const std::string& indexPath, const FileStamp& stamp)
+{
+    std::ifstream in(indexPath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    
+    serialization::BinarySerializer serializer(in);
+    if (!serializer.serializeSentinel(ROW_INDEX_MAGIC)) {
+        return false;
+    }
+    uint32_t uVersion = 0;
+    uint64_t uSize = 0, uDataStart = 0, nRows = 0;
+    int64_t mtime = 0;
+    uint8_t uCommentChar = 0;
+    serializer.serialize(uVersion);
+    serializer.serialize(uSize);
+    serializer.serialize(mtime);
+    serializer.serialize(uDataStart);
+    serializer.serialize(uCommentChar);
+    serializer.serialize(nRows);
+    if (!serializer.good() || uVersion != ROW_INDEX_VERSION || !(FileStamp{ uSize, mtime } == stamp) ||
+        uDataStart != (uint64_t)std::streamoff(m_dataStartPos) || uCommentChar != (uint8_t)m_commentChar ||
+        nRows > uSize) {
+        return false;
+    }
+    
+    m_rowOffsets.resize((size_t)nRows);
+    in.read((char*)m_rowOffsets.data(), (std::streamsize)(nRows * sizeof(uint64_t)));
+    if (!in.good()) {
+        m_rowOffsets.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CSVFileReader::saveRowIndex(const std::string& indexPath, const FileStamp& stamp) const
+{
+    std::ofstream out(indexPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    
+    serialization::BinarySerializer serializer(out);
+    serializer.serializeSentinel(ROW_INDEX_MAGIC);
+    uint32_t uVersion = ROW_INDEX_VERSION;
+    uint64_t uSize = stamp.size, uDataStart = (uint64_t)std::streamoff(m_dataStartPos), nRows = m_rowOffsets.size();
+    int64_t mtime = stamp.mtime;
+    uint8_t uCommentChar = (uint8_t)m_commentChar;
+    serializer.serialize(uVersion);
+    serializer.serialize(uSize);
+    serializer.serialize(mtime);
+    serializer.serialize(uDataStart);
+    serializer.serialize(uCommentChar);
+    serializer.serialize(nRows);
+    out.write((const char*)m_rowOffsets.data(), (std::streamsize)(nRows * sizeof(uint64_t)));
+    
+    return out.good();
+}
@@ -1,6 +1,13 @@
 #pragma once
 
+#include "CSVRowParser.h"
+#include "CSVStructuralIndex.h"
+#include "utils/fileUtils/FileChangeWatcher.h"
+#include "utils/fileUtils/FileStamp.h"
+
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <memory>
@@ -19,7 +26,7 @@ class CSVFileReader
 public:
     /**
      * @brief Constructor that opens a file for reading
-     * @param filename The path to the CSV file to read
+     * @param filename The path to the CSV file to read (".gz" files are decompressed on the fly)
      * @param commentChar If non-zero, any line whose first character is this
      *        char is skipped (both when reading the header and the rows),
      *        letting a file carry a leading provenance/comment block.
@@ -65,6 +72,49 @@ public:
      * @return Number of rows read and successfully converted
      */
     size_t readAllRowsAsNumbers(std::vector<std::vector<double>>& rows);
+
+    /**
+     * @brief Read the next complete row of a file that is still being written
+     *
+     * Follow mode for logs such as PresentMon captures: a line counts only once
+     * its newline has been written, so a partially written last line is left
+     * in the file and returned complete by a later call. When no complete row
+     * is available the call waits for the file to change (FileChangeWatcher)
+     * until timeoutMs has elapsed. If the file had no header line when it was
+     * opened, the first complete line becomes the headers.
+     *
+     * @param values Output vector to store the row values
+     * @param timeoutMs Longest time to wait for a new row (0 = do not wait)
+     * @return true if a row was read, false if none arrived within the timeout
+     */
+    bool readNewRow(std::vector<std::string>& values, uint32_t timeoutMs = 0);
+
+    /**
+     * @brief Select the columns returned by readProjectedRow()
+     * @param columnNames Header names, in the order they should be returned
+     * @return false if a name is not a header or is given twice (selection cleared)
+     */
+    bool setProjection(const std::vector<std::string>& columnNames);
+
+    /**
+     * @brief Read the next row, parsing only the columns selected with setProjection()
+     *
+     * Other columns are skipped with a delimiter scan and never copied; the rest
+     * of the line after the last selected column is not parsed at all.
+     *
+     * @param fields Output, one view per selected column (a column missing from a short row is an empty view);
+     *        the views stay valid until the next read
+     * @return true if a row was read, false at end of file or if the file is invalid
+     */
+    bool readProjectedRow(std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Read the selected columns of all remaining rows as contiguous doubles
+     * @param columnNames Header names, in the order of the output columns
+     * @param columns Output, one vector per name; empty or non-numeric fields become NaN
+     * @return Number of rows read (0 if a name is not a header)
+     */
+    size_t readColumns(const std::vector<std::string>& columnNames, std::vector<std::vector<double>>& columns);
     
     /**
      * @brief Check if file is open and valid for reading
@@ -108,14 +158,67 @@ public:
      */
     size_t getCurrentRowNumber() const { return m_currentRow; }
 
+    /**
+     * @brief Build the row offset index with one scan of the file, unless it exists
+     *
+     * The index holds the byte offset of every data row (blank and comment
+     * lines excluded) and enables seekRow() and readRows(). With bPersist the
+     * index is loaded from getRowIndexPath() when it was built from a file of
+     * the same size and modification time, and saved there otherwise.
+     *
+     * @param bPersist Load/save the index next to the CSV file
+     * @return true if the index is available
+     */
+    bool buildRowIndex(bool bPersist = false);
+
+    bool hasRowIndex() const { return m_bRowIndexBuilt; }
+
+    /**
+     * @brief Get the number of data rows in the index (0 if it was not built)
+     */
+    size_t getIndexedRowCount() const { return m_rowOffsets.size(); }
+
+    /**
+     * @brief Position the reader so that the next readRow() returns data row n
+     *
+     * Builds the row index (not persisted) on first use.
+     *
+     * @param n Data row number (0-based); n == getIndexedRowCount() positions at the end
+     * @return false if n is beyond the end or the index could not be built
+     */
+    bool seekRow(size_t n);
+
+    /**
+     * @brief Read up to count rows starting at data row first
+     * @param first Data row number (0-based)
+     * @param count Maximum number of rows to read
+     * @param rows Output vector to store the rows
+     * @return Number of rows read
+     */
+    size_t readRows(size_t first, size_t count, std::vector<std::vector<std::string>>& rows);
+
+    /**
+     * @brief Get the path where buildRowIndex(true) persists the index of a CSV file
+     */
+    static std::string getRowIndexPath(const std::string& filename);
+
 private:
     std::string m_filename;                ///< Path to the CSV file
-    std::ifstream m_file;                  ///< File stream for reading
+    std::unique_ptr<std::streambuf> m_pFileBuffer; ///< File or gzip buffer, nullptr if not open
+    std::istream m_file{ nullptr };        ///< Stream for reading over m_pFileBuffer
     std::vector<std::string> m_headers;    ///< Column headers
     char m_delimiter = ',';                ///< Delimiter character
     char m_commentChar = '\0';             ///< Skip lines starting with this (0 = disabled)
     size_t m_currentRow = 0;               ///< Current row number (0-based)
     std::streampos m_dataStartPos;         ///< Position where data starts (after headers)
+    std::string m_line;                    ///< Line buffer reused by readProjectedRow()
+    CSVRowParser m_rowParser;              ///< Field scanner for projected reads
+    std::vector<int> m_projection;         ///< Output slot per column, -1 if not selected
+    CSVStructuralIndex m_index;            ///< Vectorized field boundary scanner for parseLine()
+    std::vector<uint32_t> m_separators;    ///< Separator offsets of the line being parsed
+    std::vector<uint64_t> m_rowOffsets;    ///< Byte offset of each data row (row index)
+    bool m_bRowIndexBuilt = false;         ///< m_rowOffsets is complete
+    std::unique_ptr<FileChangeWatcher> m_pWatcher; ///< Change notifications for readNewRow()
     
     /**
      * @brief Parse a CSV line into individual fields
@@ -124,6 +227,21 @@ private:
      * @return true if parsing was successful, false otherwise
      */
     bool parseLine(const std::string& line, std::vector<std::string>& fields);
+
+    /**
+     * @brief Read one newline-terminated line, leaving an incomplete last line unread
+     * @param line Output, the line without its newline
+     * @return false if no complete line is available (the position is unchanged)
+     */
+    bool readCompleteLine(std::string& line);
+
+    /**
+     * @brief Resolve quoting in one field that contains quote characters
+     * @param pField Start of the field
+     * @param length Length of the field up to its separator
+     * @return The field with quoting resolved
+     */
+    std::string unquoteField(const char* pField, size_t length) const;
     
     /**
      * @brief Unescape a CSV field (remove quotes and handle escaped quotes)
@@ -145,4 +263,19 @@ private:
      * @return true if conversion was successful, false otherwise
      */
     bool stringToDouble(const std::string& str, double& value) const;
+
+    /**
+     * @brief Fill m_rowOffsets by scanning the file for data lines
+     */
+    bool scanRowOffsets();
+
+    /**
+     * @brief Load m_rowOffsets from a persisted index if it matches the file
+     */
+    bool loadRowIndex(const std::string& indexPath, const FileStamp& stamp);
+
+    /**
+     * @brief Persist m_rowOffsets
+     */
+    bool saveRowIndex(const std::string& indexPath, const FileStamp& stamp) const;
 };
\ No newline at end of file
@@ -1,14 +1,39 @@
 #include "CSVFileWriter.h"
+#include "utils/fileUtils/GzipStreamBuf.h"
+#include <charconv>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 
-CSVFileWriter::CSVFileWriter(const std::string& filename, const std::vector<std::string>& headers)
+namespace {
+
+// Longest fixed-notation double is 309 integer digits plus sign and point
+constexpr size_t NUMBER_CHARS = 512;
+
+}
+
+CSVFileWriter::CSVFileWriter(const std::string& filename, const std::vector<std::string>& headers, Mode mode)
     : m_filename(filename)
     , m_headers(headers)
+    , m_mode(mode)
 {
-    // Open the file for writing
-    m_file.open(filename, std::ios::out | std::ios::trunc);
+    // Open the file for writing; a ".gz" file is compressed as it is written
+    m_pFileBuffer = GzipStreamBuf::openFile(filename, std::ios::out);
+    m_file.rdbuf(m_pFileBuffer.get());
+    
+    if (m_mode == Mode::Buffered) {
+        m_buffer.reserve(BUFFER_BYTES + BUFFER_BYTES / 4);
+    }
+    
+    if (m_mode == Mode::Async && m_pFileBuffer != nullptr) {
+        for (RowBlock& block : m_blocks) {
+            block.numbers.reserve(BUFFER_BYTES / sizeof(double));
+            block.fields.reserve(BUFFER_BYTES / sizeof(RowBlock::Field));
+            block.text.reserve(BUFFER_BYTES);
+        }
+        m_asyncText.reserve(BUFFER_BYTES + BUFFER_BYTES / 4);
+        m_writerThread = std::thread(&CSVFileWriter::writerFunction, this);
+    }
     
     if (isValid()) {
         // Write the header row
@@ -23,10 +48,23 @@ CSVFileWriter::CSVFileWriter(const std::string& filename, const std::vector<std:
 
 CSVFileWriter::~CSVFileWriter()
 {
-    // Ensure file is properly closed
-    if (m_file.is_open()) {
-        m_file.close();
+    // Ensure buffered rows are written and the file is properly closed
+    if (m_pFileBuffer != nullptr) {
+        flush();
     }
+    
+    if (m_writerThread.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_bQuit = true;
+        }
+        m_cv.notify_all();
+        m_writerThread.join();
+    }
+    
+    // Destroying the buffer writes the last gzip block and closes the file
+    m_file.rdbuf(nullptr);
+    m_pFileBuffer.reset();
 }
 
 bool CSVFileWriter::addRow(const std::vector<std::string>& values)
@@ -35,17 +73,11 @@ bool CSVFileWriter::addRow(const std::vector<std::string>& values)
         return false;
     }
     
-    std::ostringstream row;
-    
-    for (size_t i = 0; i < values.size(); ++i) {
-        if (i > 0) {
-            row << m_delimiter;
-        }
-        
-        row << escapeString(values[i]);
+    for (const std::string& value : values) {
+        addField(value);
     }
     
-    return writeRow(row.str());
+    return endRow();
 }
 
 bool CSVFileWriter::addRow(const std::vector<double>& values)
@@ -54,39 +86,65 @@ bool CSVFileWriter::addRow(const std::vector<double>& values)
         return false;
     }
     
-    std::ostringstream row;
-    row << std::fixed << std::setprecision(m_precision);
+    if (m_mode == Mode::Async) {
+        // Formatting happens on the writer thread
+        RowBlock& front = m_blocks[m_frontBlock];
+        front.numbers.insert(front.numbers.end(), values.begin(), values.end());
+        front.entries.push_back({ true, values.size() });
+        if (front.getBytes() >= BUFFER_BYTES) {
+            submitFront();
+        }
+        return !m_bFailed;
+    }
     
     for (size_t i = 0; i < values.size(); ++i) {
         if (i > 0) {
-            row << m_delimiter;
+            m_buffer += m_delimiter;
         }
         
-        row << values[i];
+        appendNumber(m_buffer, values[i]);
     }
     
-    return writeRow(row.str());
+    return endRow();
 }
 
 void CSVFileWriter::flush()
 {
-    if (isValid()) {
-        m_file.flush();
+    if (!isValid()) {
+        return;
+    }
+    
+    if (m_mode == Mode::Async) {
+        // The writer thread is idle afterwards, so the stream is ours to flush
+        waitForWriter();
+    } else {
+        writeBuffer();
     }
+    m_file.flush();
 }
 
 bool CSVFileWriter::isValid() const
 {
-    return m_file.is_open() && m_file.good();
+    if (m_mode == Mode::Async) {
+        // The stream state belongs to the writer thread
+        return m_pFileBuffer != nullptr && !m_bFailed;
+    }
+    return m_pFileBuffer != nullptr && m_file.good();
 }
 
 void CSVFileWriter::setDelimiter(char delimiter)
 {
+    if (m_writerThread.joinable()) {
+        waitForWriter();
+    }
     m_delimiter = delimiter;
 }
 
 void CSVFileWriter::setPrecision(int precision)
 {
+    if (m_writerThread.joinable()) {
+        waitForWriter();
+    }
     m_precision = precision;
 }
 
@@ -119,13 +177,225 @@ std::string CSVFileWriter::escapeString(const std::string& str) const
     return "\"" + escaped + "\"";
 }
 
+void CSVFileWriter::appendEscaped(std::string& out, std::string_view str) const
+{
+    bool needsEscaping = false;
+    
+    for (char c : str) {
+        if (c == m_delimiter || c == '\n' || c == '\r' || c == '"') {
+            needsEscaping = true;
+            break;
+        }
+    }
+    
+    if (!needsEscaping) {
+        out += str;
+        return;
+    }
+    
+    // Enclose in quotes, doubling embedded quotes
+    out += '"';
+    for (char c : str) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+void CSVFileWriter::appendNumber(std::string& out, double value) const
+{
+    char text[NUMBER_CHARS];
+    std::to_chars_result result = std::to_chars(text, text + NUMBER_CHARS, value, std::chars_format::fixed, m_precision);
+    if (result.ec == std::errc()) {
+        out.append(text, result.ptr);
+        return;
+    }
+    
+    // Precision too large for the local buffer
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(m_precision) << value;
+    out += stream.str();
+}
+
+void CSVFileWriter::addField(std::string_view str)
+{
+    if (m_mode == Mode::Async) {
+        // Escaping happens on the writer thread
+        RowBlock& front = m_blocks[m_frontBlock];
+        front.text += str;
+        front.fields.push_back({ RowBlock::Field::Kind::String, str.size() });
+    } else {
+        if (m_rowFields > 0) {
+            m_buffer += m_delimiter;
+        }
+        appendEscaped(m_buffer, str);
+    }
+    ++m_rowFields;
+}
+
+void CSVFileWriter::addVerbatimField(std::string_view str)
+{
+    if (m_mode == Mode::Async) {
+        RowBlock& front = m_blocks[m_frontBlock];
+        front.text += str;
+        front.fields.push_back({ RowBlock::Field::Kind::Verbatim, str.size() });
+    } else {
+        if (m_rowFields > 0) {
+            m_buffer += m_delimiter;
+        }
+        m_buffer += str;
+    }
+    ++m_rowFields;
+}
+
+void CSVFileWriter::addNumberField(double value)
+{
+    if (m_mode == Mode::Async) {
+        RowBlock& front = m_blocks[m_frontBlock];
+        front.numbers.push_back(value);
+        front.fields.push_back({ RowBlock::Field::Kind::Number, 0 });
+    } else {
+        if (m_rowFields > 0) {
+            m_buffer += m_delimiter;
+        }
+        appendNumber(m_buffer, value);
+    }
+    ++m_rowFields;
+}
+
 bool CSVFileWriter::writeRow(const std::string& row)
 {
     if (!isValid()) {
         return false;
     }
     
-    m_file << row << std::endl;
+    addVerbatimField(row);
+    
+    return endRow();
+}
+
+bool CSVFileWriter::endRow()
+{
+    size_t fieldCount = m_rowFields;
+    m_rowFields = 0;
+    
+    if (m_mode == Mode::Async) {
+        RowBlock& front = m_blocks[m_frontBlock];
+        front.entries.push_back({ false, fieldCount });
+        if (front.getBytes() >= BUFFER_BYTES) {
+            submitFront();
+        }
+        return !m_bFailed;
+    }
+    
+    m_buffer += '\n';
+    
+    if (m_mode == Mode::LineFlushed) {
+        writeBuffer();
+        m_file.flush();
+    } else if (m_buffer.size() >= BUFFER_BYTES) {
+        writeBuffer();
+    }
     
     return m_file.good();
-} 
\ No newline at end of file
+}
+
+void CSVFileWriter::writeBuffer()
+{
+    if (!m_buffer.empty()) {
+        m_file.write(m_buffer.data(), (std::streamsize)m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+void CSVFileWriter::submitFront()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return !m_bBackPending; });
+    m_frontBlock = 1 - m_frontBlock;
+    m_bBackPending = true;
+    lock.unlock();
+    m_cv.notify_all();
+}
+
+void CSVFileWriter::waitForWriter()
+{
+    if (!m_blocks[m_frontBlock].entries.empty()) {
+        submitFront();
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return !m_bBackPending; });
+}
+
+void CSVFileWriter::writerFunction()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [this] { return m_bBackPending || m_bQuit; });
+        if (!m_bBackPending) {
+            break; // quit with nothing left to write
+        }
+        RowBlock& block = m_blocks[1 - m_frontBlock];
+        
+        lock.unlock();
+        writeBlock(block);
+        lock.lock();
+        
+        m_bBackPending = false;
+        m_cv.notify_all();
+    }
+}
+
+void CSVFileWriter::writeBlock(RowBlock& block)
+{
+    const double* pNumber = block.numbers.data();
+    const RowBlock::Field* pField = block.fields.data();
+    const char* pText = block.text.data();
+    for (const RowBlock::Entry& entry : block.entries) {
+        for (size_t i = 0; i < entry.size; ++i) {
+            if (i > 0) {
+                m_asyncText += m_delimiter;
+            }
+            
+            if (entry.isNumeric) {
+                appendNumber(m_asyncText, *pNumber++);
+                continue;
+            }
+            
+            const RowBlock::Field& field = *pField++;
+            switch (field.kind) {
+            case RowBlock::Field::Kind::String:
+                appendEscaped(m_asyncText, std::string_view(pText, field.size));
+                break;
+            case RowBlock::Field::Kind::Verbatim:
+                m_asyncText.append(pText, field.size);
+                break;
+            case RowBlock::Field::Kind::Number:
+                appendNumber(m_asyncText, *pNumber++);
+                break;
+            }
+            pText += field.size;
+        }
+        m_asyncText += '\n';
+        
+        if (m_asyncText.size() >= BUFFER_BYTES) {
+            m_file.write(m_asyncText.data(), (std::streamsize)m_asyncText.size());
+            m_asyncText.clear();
+        }
+    }
+    
+    if (!m_asyncText.empty()) {
+        m_file.write(m_asyncText.data(), (std::streamsize)m_asyncText.size());
+        m_asyncText.clear();
+    }
+    if (!m_file.good()) {
+        m_bFailed = true;
+    }
+    
+    block.entries.clear();
+    block.fields.clear();
+    block.numbers.clear();
+    block.text.clear();
+}
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <memory>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#include <type_traits>
 
 /**
  * @class CSVFile
@@ -13,16 +21,43 @@
  * 
  * Allows for writing headers and rows of data to a CSV file with proper
  * formatting and handling of various data types.
+ *
+ * Rows are assembled directly into an in-memory buffer; numbers are formatted
+ * with std::to_chars. In Mode::LineFlushed every row is written and flushed
+ * immediately. In Mode::Buffered the buffer is written once it exceeds
+ * BUFFER_BYTES and on flush() or destruction.
+ *
+ * In Mode::Async, rows are copied into one of two preallocated blocks as raw
+ * doubles and unescaped strings, so the caller only pays for a copy. A
+ * background thread escapes, formats and writes the other block. When the caller fills
+ * its block while the thread is still busy, the caller waits (backpressure).
+ * flush() and the destructor return only after every added row has been
+ * written to the file. A writer must be used from one thread at a time.
+ *
+ * For a ".gz" file every flush ends a gzip member, so flushed rows are on
+ * disk in LineFlushed mode too, at the price of compressing each row on its
+ * own; Buffered or Async mode keeps the members large.
  */
 class CSVFileWriter
 {
 public:
+    enum class Mode
+    {
+        LineFlushed,   ///< Write and flush each row as it is added
+        Buffered,      ///< Write in large blocks; call flush() to force data out
+        Async          ///< Format and write on a background thread
+    };
+
+    static constexpr size_t BUFFER_BYTES = 1 << 20; ///< Buffered mode write threshold and async block size
+
     /**
      * @brief Constructor that opens a file for writing and adds headers
-     * @param filename The path to the CSV file to create or overwrite
+     * @param filename The path to the CSV file to create or overwrite (".gz" writes gzip)
      * @param headers The column headers for the CSV file
+     * @param mode When rows reach the file (see Mode)
      */
-    CSVFileWriter(const std::string& filename, const std::vector<std::string>& headers);
+    CSVFileWriter(const std::string& filename, const std::vector<std::string>& headers,
+                  Mode mode = Mode::LineFlushed);
     
     /**
      * @brief Destructor that ensures the file is properly closed
@@ -52,7 +87,7 @@ public:
     bool addMixedRow(const Args&... args);
     
     /**
-     * @brief Flush data to disk immediately
+     * @brief Write any buffered rows and flush data to disk immediately
      */
     void flush();
     
@@ -64,12 +99,18 @@ public:
     
     /**
      * @brief Set the delimiter character (default is ',')
+     *
+     * In Mode::Async, rows added before the change are written first.
+     *
      * @param delimiter The character to use as delimiter
      */
     void setDelimiter(char delimiter);
     
     /**
      * @brief Set the precision for floating-point numbers
+     *
+     * In Mode::Async, rows added before the change are written first.
+     *
      * @param precision The number of decimal places to show
      */
     void setPrecision(int precision);
@@ -82,10 +123,61 @@ public:
 
 private:
     std::string m_filename;                ///< Path to the CSV file
-    std::ofstream m_file;                  ///< File stream for writing
+    std::unique_ptr<std::streambuf> m_pFileBuffer; ///< File or gzip buffer, nullptr if not open
+    std::ostream m_file{ nullptr };        ///< Stream for writing over m_pFileBuffer
     std::vector<std::string> m_headers;    ///< Column headers
     char m_delimiter = ',';                ///< Delimiter character
     int m_precision = 6;                   ///< Decimal precision for floating-point values
+    Mode m_mode = Mode::LineFlushed;       ///< When rows are written to the file
+    std::string m_buffer;                  ///< Rows not yet written to the file (unused in Mode::Async)
+    size_t m_rowFields = 0;                ///< Fields added to the row being assembled
+
+    /**
+     * @brief Rows handed between the caller and the async writer thread
+     */
+    struct RowBlock
+    {
+        struct Entry
+        {
+            bool isNumeric;                ///< Row of doubles in numbers, else a row of fields
+            size_t size;                   ///< Number of doubles or fields
+        };
+
+        struct Field
+        {
+            enum class Kind : uint8_t
+            {
+                String,                    ///< Raw characters in text, escaped by the writer thread
+                Verbatim,                  ///< Characters in text written as they are
+                Number                     ///< Next value in numbers
+            };
+
+            Kind kind;
+            size_t size;                   ///< Number of characters in text, 0 for Kind::Number
+        };
+
+        std::vector<Entry> entries;        ///< Rows in order
+        std::vector<Field> fields;         ///< Fields of the non-numeric rows, back to back
+        std::vector<double> numbers;       ///< Values of the numeric rows and number fields, back to back
+        std::string text;                  ///< Characters of the string fields, back to back
+
+        size_t getBytes() const
+        {
+            return numbers.size() * sizeof(double) + fields.size() * sizeof(Field) + text.size();
+        }
+    };
+
+    RowBlock m_blocks[2];                  ///< Double buffer for Mode::Async
+    int m_frontBlock = 0;                  ///< Block the caller fills; the other one belongs to the thread
+    bool m_bBackPending = false;           ///< Back block holds rows the thread has not written yet
+    bool m_bQuit = false;                  ///< Writer thread should exit
+    std::atomic<bool> m_bFailed = false;   ///< Writer thread hit a stream error
+    std::mutex m_mutex;                    ///< Guards m_frontBlock, m_bBackPending and m_bQuit
+    std::condition_variable m_cv;          ///< Signals block hand-offs in both directions
+    std::string m_asyncText;               ///< Writer thread's formatting buffer
+    std::thread m_writerThread;            ///< Formats and writes blocks in Mode::Async
+
+    static constexpr size_t INTEGER_CHARS = 24;  ///< Fits any 64-bit integer with its sign
     
     /**
      * @brief Escape a string to ensure proper CSV formatting
@@ -93,46 +185,104 @@ private:
      * @return The escaped string
      */
     std::string escapeString(const std::string& str) const;
+
+    /**
+     * @brief Append a string, enclosing it in quotes if it needs escaping
+     */
+    void appendEscaped(std::string& out, std::string_view str) const;
+
+    /**
+     * @brief Append a number in fixed notation with the configured precision
+     */
+    void appendNumber(std::string& out, double value) const;
     
+    /**
+     * @brief Add a string field to the row being assembled; it is escaped if needed
+     */
+    void addField(std::string_view str);
+
+    /**
+     * @brief Add a field that is written exactly as given
+     */
+    void addVerbatimField(std::string_view str);
+
+    /**
+     * @brief Add a number field in fixed notation with the configured precision
+     */
+    void addNumberField(double value);
+
     /**
      * @brief Write a row to the CSV file
      * @param row The row data as a string
      * @return true if successful, false otherwise
      */
     bool writeRow(const std::string& row);
+
+    /**
+     * @brief Terminate the row being assembled and write it out as the mode requires
+     * @return true if successful, false otherwise
+     */
+    bool endRow();
+
+    /**
+     * @brief Write the buffer to the file stream and clear it
+     */
+    void writeBuffer();
+
+    /**
+     * @brief Hand the front block to the writer thread, waiting while it is busy
+     */
+    void submitFront();
+
+    /**
+     * @brief Hand over any rows in the front block and wait until the thread has written them
+     */
+    void waitForWriter();
+
+    /**
+     * @brief Writer thread: format and write back blocks until asked to quit
+     */
+    void writerFunction();
+
+    /**
+     * @brief Escape and format the rows of a block and write them to the file stream
+     */
+    void writeBlock(RowBlock& block);
 };
 
 // Template implementation
 template<typename... Args>
 bool CSVFileWriter::addMixedRow(const Args&... args)
 {
-    std::ostringstream row;
-    int idx = 0;
+    if (!isValid()) {
+        return false;
+    }
     
     // Function to process each argument
     auto processArg = [&](const auto& arg) {
-        if (idx > 0) {
-            row << m_delimiter;
-        }
-        
         using ArgType = std::decay_t<decltype(arg)>;
         
-        if constexpr (std::is_same_v<ArgType, std::string> || 
-                      std::is_same_v<ArgType, const char*>) {
-            row << escapeString(arg);
+        if constexpr (std::is_convertible_v<ArgType, std::string_view>) {
+            addField(arg);
         }
         else if constexpr (std::is_floating_point_v<ArgType>) {
-            row << std::fixed << std::setprecision(m_precision) << arg;
+            addNumberField(arg);
+        }
+        else if constexpr (std::is_integral_v<ArgType> && !std::is_same_v<ArgType, bool> &&
+                           !std::is_same_v<ArgType, char>) {
+            char text[INTEGER_CHARS];
+            std::to_chars_result result = std::to_chars(text, text + INTEGER_CHARS, arg);
+            addVerbatimField(std::string_view(text, result.ptr - text));
         }
         else {
-            row << arg;
+            std::ostringstream text;
+            text << arg;
+            addVerbatimField(text.str());
         }
-        
-        idx++;
     };
     
     // Process all arguments
     (processArg(args), ...);
     
-    return writeRow(row.str());
+    return endRow();
 } 
\ No newline at end of file
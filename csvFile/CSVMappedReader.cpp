@@ -0,0 +1,128 @@
+#include "CSVMappedReader.h"
+#include "CSVNumber.h"
+#include <limits>
+
+CSVMappedReader::CSVMappedReader(const std::string& filename, char commentChar)
+    : m_filename(filename), m_commentChar(commentChar)
+{
+    if (m_file.open(filename)) {
+        readHeaders();
+    }
+}
+
+bool CSVMappedReader::readRow(std::vector<std::string_view>& fields)
+{
+    fields.clear();
+    if (!isValid() || !skipIgnoredLines()) {
+        return false;
+    }
+
+    const char* pData = m_file.data();
+    const char* pNext = m_parser.parseRow(pData + m_pos, pData + m_file.size(), fields);
+    m_pos = pNext - pData;
+    m_currentRow++;
+    return true;
+}
+
+bool CSVMappedReader::setProjection(const std::vector<std::string>& columnNames)
+{
+    return CSVRowParser::buildProjection(m_headers, columnNames, m_projection);
+}
+
+bool CSVMappedReader::readProjectedRow(std::vector<std::string_view>& fields)
+{
+    fields.clear();
+    if (!isValid() || !skipIgnoredLines()) {
+        return false;
+    }
+
+    const char* pData = m_file.data();
+    const char* pNext = m_parser.parseProjectedRow(pData + m_pos, pData + m_file.size(), m_projection, fields);
+    m_pos = pNext - pData;
+    m_currentRow++;
+    return true;
+}
+
+size_t CSVMappedReader::readColumns(const std::vector<std::string>& columnNames, std::vector<std::vector<double>>& columns)
+{
+    columns.assign(columnNames.size(), std::vector<double>());
+    if (!setProjection(columnNames)) {
+        return 0;
+    }
+
+    std::vector<std::string_view> fields;
+    size_t count = 0;
+    while (readProjectedRow(fields)) {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            double value;
+            if (CSVNumber::parse(fields[i], value) != CSVNumber::Status::Ok) {
+                value = std::numeric_limits<double>::quiet_NaN();
+            }
+            columns[i].push_back(value);
+        }
+        count++;
+    }
+    return count;
+}
+
+bool CSVMappedReader::isEndOfFile() const
+{
+    return m_pos >= m_file.size();
+}
+
+bool CSVMappedReader::reset()
+{
+    if (!isValid()) {
+        return false;
+    }
+    m_pos = m_dataStart;
+    m_currentRow = 0;
+    return true;
+}
+
+void CSVMappedReader::setDelimiter(char delimiter)
+{
+    m_parser.setDelimiter(delimiter);
+    if (isValid()) {
+        readHeaders();
+    }
+}
+
+bool CSVMappedReader::skipIgnoredLines()
+{
+    const char* pData = m_file.data();
+    size_t size = m_file.size();
+    while (m_pos < size) {
+        char c = pData[m_pos];
+        bool isBlank = (c == '\n') || (c == '\r' && (m_pos + 1 == size || pData[m_pos + 1] == '\n'));
+        bool isComment = m_commentChar != '\0' && c == m_commentChar;
+        if (!isBlank && !isComment) {
+            return true;
+        }
+        // skip to the next line
+        while (m_pos < size && pData[m_pos] != '\n') {
+            ++m_pos;
+        }
+        ++m_pos;
+    }
+    m_pos = size;
+    return false;
+}
+
+bool CSVMappedReader::readHeaders()
+{
+    m_headers.clear();
+    m_pos = 0;
+    m_currentRow = 0;
+
+    std::vector<std::string_view> fields;
+    bool success = false;
+    if (skipIgnoredLines()) {
+        const char* pData = m_file.data();
+        m_pos = m_parser.parseRow(pData + m_pos, pData + m_file.size(), fields) - pData;
+        m_headers.assign(fields.begin(), fields.end());
+        success = true;
+    }
+    m_dataStart = m_pos;
+    return success;
+}
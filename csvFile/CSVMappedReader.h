@@ -0,0 +1,136 @@
+#pragma once
+
+#include "CSVRowParser.h"
+#include "utils/fileUtils/MappedFile.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class CSVMappedReader
+ * @brief Zero-copy CSV reader over a memory-mapped file
+ *
+ * Same interface as CSVFileReader, but rows are returned as std::string_view
+ * fields pointing into the mapping instead of freshly allocated strings. Only
+ * fields that contain escaped quotes are materialized. Quoted fields may span
+ * lines.
+ *
+ * Field views stay valid until the next readRow() or reset() call (views into
+ * the mapping itself stay valid for the reader's lifetime).
+ */
+class CSVMappedReader
+{
+public:
+    /**
+     * @brief Constructor that maps a file for reading
+     * @param filename The path to the CSV file to read (".gz" files are decompressed into memory)
+     * @param commentChar If non-zero, lines starting with this char are skipped
+     */
+    explicit CSVMappedReader(const std::string& filename, char commentChar = '\0');
+
+    /**
+     * @brief Get the headers from the CSV file
+     * @return Vector of header strings, empty if no headers or file invalid
+     */
+    const std::vector<std::string>& getHeaders() const { return m_headers; }
+
+    /**
+     * @brief Read the next row as views of its fields
+     * @param fields Output vector of field views
+     * @return true if a row was read, false at end of file or if the file is invalid
+     */
+    bool readRow(std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Select the columns returned by readProjectedRow()
+     * @param columnNames Header names, in the order they should be returned
+     * @return false if a name is not a header or is given twice (selection cleared)
+     */
+    bool setProjection(const std::vector<std::string>& columnNames);
+
+    /**
+     * @brief Read the next row, parsing only the columns selected with setProjection()
+     *
+     * Other columns are skipped with a delimiter scan and never copied; the rest
+     * of the record after the last selected column is not parsed at all.
+     *
+     * @param fields Output, one view per selected column (a column missing from a short row is an empty view);
+     *        the views follow the same lifetime rules as readRow()
+     * @return true if a row was read, false at end of file or if the file is invalid
+     */
+    bool readProjectedRow(std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Read the selected columns of all remaining rows as contiguous doubles
+     * @param columnNames Header names, in the order of the output columns
+     * @param columns Output, one vector per name; empty or non-numeric fields become NaN
+     * @return Number of rows read (0 if a name is not a header)
+     */
+    size_t readColumns(const std::vector<std::string>& columnNames, std::vector<std::vector<double>>& columns);
+
+    /**
+     * @brief Check if the file is mapped and valid for reading
+     */
+    bool isValid() const { return m_file.isOpen(); }
+
+    /**
+     * @brief Check if all rows have been read
+     */
+    bool isEndOfFile() const;
+
+    /**
+     * @brief Reset position to the first data row (after headers)
+     * @return true if successful, false otherwise
+     */
+    bool reset();
+
+    /**
+     * @brief Get the number of columns based on header count
+     */
+    size_t getColumnCount() const { return m_headers.size(); }
+
+    /**
+     * @brief Set the delimiter character (default is ',') and re-read the headers
+     */
+    void setDelimiter(char delimiter);
+
+    const std::string& getFilename() const { return m_filename; }
+
+    /**
+     * @brief Get the current row number (1-based, excluding header)
+     */
+    size_t getCurrentRowNumber() const { return m_currentRow; }
+
+    /**
+     * @brief Get the whole mapped file contents
+     */
+    std::string_view getContents() const { return m_file.view(); }
+
+    /**
+     * @brief Byte offset of the next row to be read
+     */
+    size_t getPosition() const { return m_pos; }
+
+private:
+    std::string m_filename;                ///< Path to the CSV file
+    MappedFile m_file;                     ///< Mapping of the whole file
+    CSVRowParser m_parser;                 ///< Field parser (owns unescaped fields)
+    std::vector<std::string> m_headers;    ///< Column headers
+    char m_commentChar = '\0';             ///< Skip lines starting with this (0 = disabled)
+    size_t m_currentRow = 0;               ///< Current row number (0-based)
+    size_t m_dataStart = 0;                ///< Offset where data starts (after headers)
+    size_t m_pos = 0;                      ///< Offset of the next unread byte
+    std::vector<int> m_projection;         ///< Output slot per column, -1 if not selected
+
+    /**
+     * @brief Advance m_pos past blank and comment lines
+     * @return true if a record starts at m_pos
+     */
+    bool skipIgnoredLines();
+
+    /**
+     * @brief Read the headers from the start of the file
+     */
+    bool readHeaders();
+};
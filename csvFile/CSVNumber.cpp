@@ -0,0 +1,80 @@
+#include "CSVNumber.h"
+#include <charconv>
+
+namespace {
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// from_chars rejects a leading '+', std::stod accepts it
+std::string_view stripPlus(std::string_view text)
+{
+    if (text.size() > 1 && text[0] == '+' && text[1] != '-' && text[1] != '+') {
+        text.remove_prefix(1);
+    }
+    return text;
+}
+
+CSVNumber::Status toStatus(const std::from_chars_result& result, const char* pEnd)
+{
+    if (result.ec == std::errc::result_out_of_range) {
+        return CSVNumber::Status::OutOfRange;
+    }
+    if (result.ec != std::errc() || result.ptr != pEnd) {
+        return CSVNumber::Status::Invalid;
+    }
+    return CSVNumber::Status::Ok;
+}
+
+} // namespace
+
+CSVNumber::Status CSVNumber::parse(std::string_view text, double& value)
+{
+    value = 0.0;
+    text = trim(text);
+    if (text.empty()) {
+        return Status::Empty;
+    }
+    text = stripPlus(text);
+
+    const char* pEnd = text.data() + text.size();
+    double parsed;
+    Status status = toStatus(std::from_chars(text.data(), pEnd, parsed), pEnd);
+    if (status == Status::Ok) {
+        value = parsed;
+    }
+    return status;
+}
+
+CSVNumber::Status CSVNumber::parse(std::string_view text, int64_t& value)
+{
+    value = 0;
+    text = trim(text);
+    if (text.empty()) {
+        return Status::Empty;
+    }
+    text = stripPlus(text);
+
+    const char* pEnd = text.data() + text.size();
+    int64_t parsed;
+    Status status = toStatus(std::from_chars(text.data(), pEnd, parsed), pEnd);
+    if (status == Status::Ok) {
+        value = parsed;
+    }
+    return status;
+}
+
+std::string_view CSVNumber::trim(std::string_view text)
+{
+    size_t first = 0;
+    while (first < text.size() && isSpace(text[first])) {
+        ++first;
+    }
+    size_t last = text.size();
+    while (last > first && isSpace(text[last - 1])) {
+        --last;
+    }
+    return text.substr(first, last - first);
+}
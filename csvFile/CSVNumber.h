@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @class CSVNumber
+ * @brief Locale-independent, exception-free number parsing of CSV fields
+ *
+ * Works in place on a view: leading and trailing whitespace is skipped by
+ * narrowing the view, and the rest must be consumed entirely by
+ * std::from_chars. A leading '+' is accepted like std::stod does.
+ */
+class CSVNumber
+{
+public:
+    enum class Status
+    {
+        Ok,
+        Empty,         ///< Nothing but whitespace
+        Invalid,       ///< Not entirely a number
+        OutOfRange     ///< A number, but not representable in the target type
+    };
+
+    /**
+     * @brief Parse a field as double
+     * @param value Output, 0 unless the status is Ok
+     */
+    static Status parse(std::string_view text, double& value);
+
+    /**
+     * @brief Parse a field as a decimal integer
+     * @param value Output, 0 unless the status is Ok
+     */
+    static Status parse(std::string_view text, int64_t& value);
+
+    /**
+     * @brief Narrow a view to exclude leading and trailing whitespace
+     */
+    static std::string_view trim(std::string_view text);
+};
@@ -0,0 +1,166 @@
+#include "CSVParallelReader.h"
+#include "CSVNumber.h"
+#include "CSVRowParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+CSVParallelReader::CSVParallelReader(const std::string& filename, char commentChar)
+    : m_reader(filename, commentChar), m_commentChar(commentChar)
+{
+}
+
+void CSVParallelReader::setDelimiter(char delimiter)
+{
+    m_delimiter = delimiter;
+    m_reader.setDelimiter(delimiter);
+}
+
+size_t CSVParallelReader::readAllRows(std::vector<std::vector<std::string>>& rows)
+{
+    rows.clear();
+    if (!isValid()) {
+        return 0;
+    }
+
+    m_bProjected = false;
+    std::vector<Chunk> chunks;
+    parseChunks(chunks);
+
+    size_t nRows = 0;
+    for (const Chunk& chunk : chunks) {
+        nRows += chunk.nRows;
+    }
+    rows.reserve(nRows);
+    for (Chunk& chunk : chunks) {
+        std::move(chunk.rows.begin(), chunk.rows.end(), std::back_inserter(rows));
+    }
+    return nRows;
+}
+
+size_t CSVParallelReader::readColumns(const std::vector<std::string>& columnNames,
+                                      std::vector<std::vector<double>>& columns)
+{
+    columns.assign(columnNames.size(), std::vector<double>());
+    if (!isValid() || !CSVRowParser::buildProjection(getHeaders(), columnNames, m_projection)) {
+        return 0;
+    }
+
+    m_bProjected = true;
+    m_nSelected = columnNames.size();
+    std::vector<Chunk> chunks;
+    parseChunks(chunks);
+
+    size_t nRows = 0;
+    for (const Chunk& chunk : chunks) {
+        nRows += chunk.nRows;
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        columns[i].reserve(nRows);
+        for (const Chunk& chunk : chunks) {
+            columns[i].insert(columns[i].end(), chunk.columns[i].begin(), chunk.columns[i].end());
+        }
+    }
+    return nRows;
+}
+
+void CSVParallelReader::parseChunks(std::vector<Chunk>& chunks)
+{
+    m_reader.reset();
+    size_t dataStart = m_reader.getPosition();
+    size_t size = m_reader.getContents().size();
+    size_t dataSize = size - dataStart;
+
+    size_t nThreads = m_nThreads != 0 ? m_nThreads : std::max(1u, std::thread::hardware_concurrency());
+    size_t nChunks = std::max<size_t>(1, std::min(nThreads, dataSize / MIN_CHUNK_BYTES));
+    chunks.resize(nChunks);
+    for (size_t i = 0; i < nChunks; ++i) {
+        Chunk& chunk = chunks[i];
+        chunk.begin = dataStart + dataSize * i / nChunks;
+        chunk.end = dataStart + dataSize * (i + 1) / nChunks;
+        // speculate that the first line start in the range is a record start
+        chunk.start = skipIgnoredLines(i == 0 ? dataStart : findLineStart(chunk.begin));
+    }
+
+    // Pass 1: parse all chunks concurrently, the first one on this thread
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < nChunks; ++i) {
+        threads.emplace_back(&CSVParallelReader::parseChunk, this, std::ref(chunks[i]));
+    }
+    parseChunk(chunks[0]);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Pass 2: a chunk is valid if it started where its predecessor stopped
+    for (size_t i = 1; i < nChunks; ++i) {
+        if (chunks[i].start != chunks[i - 1].stop) {
+            chunks[i].start = chunks[i - 1].stop;
+            parseChunk(chunks[i]);
+        }
+    }
+}
+
+void CSVParallelReader::parseChunk(Chunk& chunk) const
+{
+    const char* pData = m_reader.getContents().data();
+    const char* pEnd = pData + m_reader.getContents().size();
+    CSVRowParser parser(m_delimiter);
+
+    chunk.rows.clear();
+    chunk.columns.assign(m_bProjected ? m_nSelected : 0, std::vector<double>());
+    chunk.nRows = 0;
+
+    std::vector<std::string_view> fields;
+    size_t pos = chunk.start;
+    for (;;) {
+        pos = skipIgnoredLines(pos);
+        if (pos >= chunk.end) {
+            break;
+        }
+        if (m_bProjected) {
+            pos = parser.parseProjectedRow(pData + pos, pEnd, m_projection, fields) - pData;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                double value;
+                if (CSVNumber::parse(fields[i], value) != CSVNumber::Status::Ok) {
+                    value = std::numeric_limits<double>::quiet_NaN();
+                }
+                chunk.columns[i].push_back(value);
+            }
+        } else {
+            pos = parser.parseRow(pData + pos, pEnd, fields) - pData;
+            chunk.rows.emplace_back(fields.begin(), fields.end());
+        }
+        chunk.nRows++;
+    }
+    chunk.stop = pos;
+}
+
+size_t CSVParallelReader::findLineStart(size_t pos) const
+{
+    std::string_view contents = m_reader.getContents();
+    if (pos == 0 || contents[pos - 1] == '\n') {
+        return pos;
+    }
+    const char* pNewline = (const char*)memchr(contents.data() + pos, '\n', contents.size() - pos);
+    return pNewline != nullptr ? (size_t)(pNewline - contents.data()) + 1 : contents.size();
+}
+
+size_t CSVParallelReader::skipIgnoredLines(size_t pos) const
+{
+    std::string_view contents = m_reader.getContents();
+    size_t size = contents.size();
+    while (pos < size) {
+        char c = contents[pos];
+        bool isBlank = (c == '\n') || (c == '\r' && (pos + 1 == size || contents[pos + 1] == '\n'));
+        bool isComment = m_commentChar != '\0' && c == m_commentChar;
+        if (!isBlank && !isComment) {
+            return pos;
+        }
+        pos = findLineStart(pos + 1);
+    }
+    return size;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "CSVMappedReader.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @class CSVParallelReader
+ * @brief Multi-threaded CSV reader over a memory-mapped file
+ *
+ * The data section is split into byte ranges, one per thread; a record belongs
+ * to the range it starts in. Each range speculatively starts at its first line
+ * start and is parsed concurrently. Afterwards the ranges are validated in
+ * order: a range whose speculative start differs from the point where the
+ * previous range actually stopped (its start fell inside a quoted field that
+ * contains newlines) is parsed again from the correct position. Results are
+ * concatenated in file order.
+ *
+ * Parsing semantics (quoting, CRLF, blank and comment lines) are those of
+ * CSVMappedReader.
+ */
+class CSVParallelReader
+{
+public:
+    static constexpr size_t MIN_CHUNK_BYTES = 1 << 20; ///< Smaller files are not split further
+
+    /**
+     * @brief Constructor that maps a file for reading
+     * @param filename The path to the CSV file to read
+     * @param commentChar If non-zero, lines starting with this char are skipped
+     */
+    explicit CSVParallelReader(const std::string& filename, char commentChar = '\0');
+
+    const std::vector<std::string>& getHeaders() const { return m_reader.getHeaders(); }
+    bool isValid() const { return m_reader.isValid(); }
+    const std::string& getFilename() const { return m_reader.getFilename(); }
+
+    /**
+     * @brief Set the delimiter character (default is ',') and re-read the headers
+     */
+    void setDelimiter(char delimiter);
+
+    /**
+     * @brief Set the number of parsing threads (0 = hardware concurrency)
+     */
+    void setThreadCount(unsigned nThreads) { m_nThreads = nThreads; }
+
+    /**
+     * @brief Read all data rows as strings
+     * @param rows Output, one vector of fields per row in file order
+     * @return Number of rows read
+     */
+    size_t readAllRows(std::vector<std::vector<std::string>>& rows);
+
+    /**
+     * @brief Read the selected columns of all data rows as contiguous doubles
+     * @param columnNames Header names, in the order of the output columns
+     * @param columns Output, one vector per name; empty or non-numeric fields become NaN
+     * @return Number of rows read (0 if a name is not a header)
+     */
+    size_t readColumns(const std::vector<std::string>& columnNames, std::vector<std::vector<double>>& columns);
+
+private:
+    struct Chunk
+    {
+        size_t begin = 0;                              ///< Records starting in [begin, end) belong here
+        size_t end = 0;
+        size_t start = 0;                              ///< Where parsing started
+        size_t stop = 0;                               ///< First record start at or after end
+        std::vector<std::vector<std::string>> rows;    ///< Parsed rows (readAllRows)
+        std::vector<std::vector<double>> columns;      ///< Parsed columns (readColumns)
+        size_t nRows = 0;
+    };
+
+    CSVMappedReader m_reader;              ///< Mapping and headers
+    char m_delimiter = ',';                ///< Delimiter character
+    char m_commentChar = '\0';             ///< Skip lines starting with this (0 = disabled)
+    unsigned m_nThreads = 0;               ///< Parsing threads (0 = hardware concurrency)
+    std::vector<int> m_projection;         ///< Output slot per column for readColumns()
+    size_t m_nSelected = 0;                ///< Number of selected columns for readColumns()
+    bool m_bProjected = false;             ///< Chunks produce columns instead of rows
+
+    /**
+     * @brief Split the data section, parse all chunks and fix up mis-speculated ones
+     */
+    void parseChunks(std::vector<Chunk>& chunks);
+
+    /**
+     * @brief Parse the records of a chunk starting at chunk.start
+     */
+    void parseChunk(Chunk& chunk) const;
+
+    /**
+     * @brief Position of the first line start at or after pos
+     */
+    size_t findLineStart(size_t pos) const;
+
+    /**
+     * @brief Advance past blank and comment lines
+     * @return Position of the next record start (or the file size)
+     */
+    size_t skipIgnoredLines(size_t pos) const;
+};
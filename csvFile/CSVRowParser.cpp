@@ -0,0 +1,177 @@
+#include "CSVRowParser.h"
+#include <algorithm>
+#include <cstring>
+
+const char* CSVRowParser::parseRow(const char* pBegin, const char* pEnd, std::vector<std::string_view>& fields)
+{
+    fields.clear();
+    m_nMaterialized = 0;
+
+    const char* pNext = m_index.scanRecord(pBegin, pEnd, m_separators);
+    const char* pField = pBegin;
+    for (uint32_t separator : m_separators) {
+        const char* pFieldEnd = pBegin + separator;
+        fields.push_back(sliceField(pField, pFieldEnd, pEnd));
+        pField = pFieldEnd + 1; // skip delimiter
+    }
+    return pNext;
+}
+
+const char* CSVRowParser::parseProjectedRow(const char* pBegin, const char* pEnd, const std::vector<int>& slots,
+                                            std::vector<std::string_view>& fields)
+{
+    m_nMaterialized = 0;
+    size_t nSelected = 0;
+    for (int slot : slots) {
+        if (slot >= 0) {
+            nSelected++;
+        }
+    }
+    fields.assign(nSelected, std::string_view());
+
+    const char* pNext = m_index.scanRecord(pBegin, pEnd, m_separators);
+    size_t nColumns = std::min(m_separators.size(), slots.size());
+    const char* pField = pBegin;
+    for (size_t column = 0; column < nColumns; ++column) {
+        const char* pFieldEnd = pBegin + m_separators[column];
+        if (slots[column] >= 0) {
+            fields[slots[column]] = sliceField(pField, pFieldEnd, pEnd);
+        }
+        pField = pFieldEnd + 1;
+    }
+    return pNext;
+}
+
+bool CSVRowParser::buildProjection(const std::vector<std::string>& headers,
+                                   const std::vector<std::string>& columnNames, std::vector<int>& slots)
+{
+    slots.assign(headers.size(), -1);
+    for (size_t i = 0; i < columnNames.size(); ++i) {
+        size_t column = 0;
+        while (column < headers.size() && headers[column] != columnNames[i]) {
+            column++;
+        }
+        if (column == headers.size() || slots[column] >= 0) {
+            slots.clear();
+            return false;
+        }
+        slots[column] = (int)i;
+    }
+    return true;
+}
+
+const char* CSVRowParser::skipRow(const char* pBegin, const char* pEnd) const
+{
+    return m_index.findRecordEnd(pBegin, pEnd);
+}
+
+std::string_view CSVRowParser::parseField(const char* p, const char* pEnd, const char*& pFieldEnd)
+{
+    const char* pStart = p;
+    if (p < pEnd && *p == '"') {
+        // Quoted field: fast path when the closing quote is followed by the field end
+        const char* pClose = (const char*)memchr(p + 1, '"', pEnd - p - 1);
+        if (pClose != nullptr) {
+            const char* pAfter = pClose + 1;
+            if (pAfter == pEnd || *pAfter == m_delimiter || *pAfter == '\n') {
+                pFieldEnd = pAfter;
+                return std::string_view(p + 1, pClose - p - 1);
+            }
+            if (*pAfter == '\r' && (pAfter + 1 == pEnd || pAfter[1] == '\n')) {
+                pFieldEnd = pAfter + 1;
+                return std::string_view(p + 1, pClose - p - 1);
+            }
+        }
+        return parseFieldSlow(pStart, pEnd, pFieldEnd);
+    }
+
+    // Unquoted field
+    while (p < pEnd) {
+        char c = *p;
+        if (c == m_delimiter || c == '\n') {
+            break;
+        }
+        if (c == '"') {
+            return parseFieldSlow(pStart, pEnd, pFieldEnd);
+        }
+        ++p;
+    }
+    pFieldEnd = p;
+    // CRLF tolerance: drop '\r' before the record terminator
+    if (p > pStart && p[-1] == '\r' && (p == pEnd || *p == '\n')) {
+        --p;
+    }
+    return std::string_view(pStart, p - pStart);
+}
+
+const char* CSVRowParser::skipField(const char* p, const char* pEnd) const
+{
+    bool inQuotes = false;
+    for (; p < pEnd; ++p) {
+        char c = *p;
+        if (c == '"') {
+            inQuotes = !inQuotes; // an escaped "" toggles twice
+        } else if (!inQuotes && (c == m_delimiter || c == '\n')) {
+            break;
+        }
+    }
+    return p;
+}
+
+std::string_view CSVRowParser::sliceField(const char* pField, const char* pFieldEnd, const char* pEnd)
+{
+    const char* pLast = pFieldEnd;
+    // CRLF tolerance: drop '\r' before the record terminator
+    if (pLast > pField && pLast[-1] == '\r' && (pFieldEnd == pEnd || *pFieldEnd == '\n')) {
+        --pLast;
+    }
+    size_t length = pLast - pField;
+    if (memchr(pField, '"', length) == nullptr) {
+        return std::string_view(pField, length);
+    }
+    // Quoted field without inner quotes views the text between its quotes
+    if (length >= 2 && *pField == '"' && pLast[-1] == '"' && memchr(pField + 1, '"', length - 2) == nullptr) {
+        return std::string_view(pField + 1, length - 2);
+    }
+    const char* pSlowEnd;
+    return parseFieldSlow(pField, pEnd, pSlowEnd);
+}
+
+std::string& CSVRowParser::nextMaterialized()
+{
+    if (m_nMaterialized == m_materialized.size()) {
+        m_materialized.emplace_back();
+    }
+    std::string& s = m_materialized[m_nMaterialized++];
+    s.clear();
+    return s;
+}
+
+// General case with the same semantics as CSVFileReader: quotes toggle quoting
+// anywhere in the field, "" inside quotes is a literal quote.
+std::string_view CSVRowParser::parseFieldSlow(const char* pFieldStart, const char* pEnd, const char*& pFieldEnd)
+{
+    std::string& field = nextMaterialized();
+    bool inQuotes = false;
+    const char* p = pFieldStart;
+    for (; p < pEnd; ++p) {
+        char c = *p;
+        if (c == '"') {
+            if (inQuotes && p + 1 < pEnd && p[1] == '"') {
+                field += '"';
+                ++p;
+            } else {
+                inQuotes = !inQuotes;
+            }
+        } else if (!inQuotes && (c == m_delimiter || c == '\n')) {
+            break;
+        } else {
+            field += c;
+        }
+    }
+    pFieldEnd = p;
+    if (!field.empty() && field.back() == '\r' && (p == pEnd || *p == '\n')) {
+        field.pop_back();
+    }
+    return field;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CSVStructuralIndex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class CSVRowParser
+ * @brief Zero-copy parser of CSV records in a character buffer
+ *
+ * Fields are returned as std::string_view into the buffer. A quoted field
+ * without escaped quotes views the text between its quotes; only fields that
+ * need unescaping ("" inside quotes, or quotes in the middle of a field) are
+ * materialized into storage owned by the parser. Views of materialized fields
+ * stay valid until the next parseRow() call.
+ *
+ * A record ends at an unquoted '\n' (a preceding '\r' is dropped), so quoted
+ * fields may contain newlines. parseRow(), parseProjectedRow() and skipRow()
+ * locate field boundaries with CSVStructuralIndex; parseField()/skipField()
+ * are the scalar per-field scanners.
+ */
+class CSVRowParser
+{
+public:
+    explicit CSVRowParser(char delimiter = ',') : m_delimiter(delimiter), m_index(delimiter) {}
+
+    void setDelimiter(char delimiter)
+    {
+        m_delimiter = delimiter;
+        m_index.setDelimiter(delimiter);
+    }
+    char getDelimiter() const { return m_delimiter; }
+
+    /**
+     * @brief Parse one record
+     * @param pBegin Start of the record
+     * @param pEnd End of the buffer
+     * @param fields Output views of the record's fields
+     * @return Position after the record's terminator (or pEnd)
+     */
+    const char* parseRow(const char* pBegin, const char* pEnd, std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Parse only the selected fields of one record
+     *
+     * Unselected fields are never copied or unescaped.
+     *
+     * @param slots slots[column] = output position of that column, or -1 (see buildProjection)
+     * @param fields Output, one view per selected column; columns missing from a short record are empty views
+     * @return Position after the record's terminator (or pEnd)
+     */
+    const char* parseProjectedRow(const char* pBegin, const char* pEnd, const std::vector<int>& slots,
+                                  std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Map column indices to output positions for parseProjectedRow()
+     * @param headers Column headers of the file
+     * @param columnNames Columns to select, in output order
+     * @param slots Output: slots[column] = position in columnNames, or -1 if not selected
+     * @return false if a name is not among the headers or is selected twice
+     */
+    static bool buildProjection(const std::vector<std::string>& headers,
+                                const std::vector<std::string>& columnNames, std::vector<int>& slots);
+
+    /**
+     * @brief Find the end of a record without producing fields
+     * @return Position after the record's terminator (or pEnd)
+     */
+    const char* skipRow(const char* pBegin, const char* pEnd) const;
+
+    /**
+     * @brief Parse the field starting at p
+     * @param pFieldEnd Output: position of the delimiter, '\n' or pEnd that ends the field
+     * @return The field's (unescaped) value
+     */
+    std::string_view parseField(const char* p, const char* pEnd, const char*& pFieldEnd);
+
+    /**
+     * @brief Find the end of the field starting at p without producing its value
+     * @return Position of the delimiter, '\n' or pEnd that ends the field
+     */
+    const char* skipField(const char* p, const char* pEnd) const;
+
+private:
+    char m_delimiter;
+    CSVStructuralIndex m_index;
+    std::vector<uint32_t> m_separators;    ///< Separator offsets of the current record
+
+    // Unescaped fields of the current row. A deque never moves its elements,
+    // so views into earlier fields survive later push_backs.
+    std::deque<std::string> m_materialized;
+    size_t m_nMaterialized = 0;
+
+    std::string& nextMaterialized();
+    /**
+     * @brief Value of the field in [pField, pFieldEnd), where pFieldEnd is a separator found by the index
+     */
+    std::string_view sliceField(const char* pField, const char* pFieldEnd, const char* pEnd);
+    std::string_view parseFieldSlow(const char* pFieldStart, const char* pEnd, const char*& pFieldEnd);
+};
@@ -0,0 +1,162 @@
+#include "CSVStructuralIndex.h"
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSV_INDEX_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_INDEX_SSE2
+#endif
+
+namespace {
+
+struct BlockMasks
+{
+    uint64_t quotes;
+    uint64_t delimiters;
+    uint64_t newlines;
+};
+
+#if defined(CSV_INDEX_AVX2)
+
+uint64_t matchMask(__m256i lo, __m256i hi, char c)
+{
+    __m256i needle = _mm256_set1_epi8(c);
+    uint32_t maskLo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle));
+    uint32_t maskHi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle));
+    return ((uint64_t)maskHi << 32) | maskLo;
+}
+
+BlockMasks classifyBlock(const char* p, char delimiter)
+{
+    __m256i lo = _mm256_loadu_si256((const __m256i*)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(p + 32));
+    return { matchMask(lo, hi, '"'), matchMask(lo, hi, delimiter), matchMask(lo, hi, '\n') };
+}
+
+#elif defined(CSV_INDEX_SSE2)
+
+uint64_t matchMask(const __m128i* pChunks, char c)
+{
+    __m128i needle = _mm_set1_epi8(c);
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(pChunks[i], needle));
+        mask |= bits << (16 * i);
+    }
+    return mask;
+}
+
+BlockMasks classifyBlock(const char* p, char delimiter)
+{
+    __m128i chunks[4];
+    for (int i = 0; i < 4; ++i) {
+        chunks[i] = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+    }
+    return { matchMask(chunks, '"'), matchMask(chunks, delimiter), matchMask(chunks, '\n') };
+}
+
+#else
+
+BlockMasks classifyBlock(const char* p, char delimiter)
+{
+    BlockMasks masks = { 0, 0, 0 };
+    for (size_t i = 0; i < CSVStructuralIndex::BLOCK_SIZE; ++i) {
+        uint64_t bit = 1ull << i;
+        char c = p[i];
+        if (c == '"') {
+            masks.quotes |= bit;
+        } else if (c == delimiter) {
+            masks.delimiters |= bit;
+        } else if (c == '\n') {
+            masks.newlines |= bit;
+        }
+    }
+    return masks;
+}
+
+#endif
+
+// Bit i of the result is the XOR of bits 0..i of x, i.e. set for every
+// position preceded (inclusively) by an odd number of quotes.
+uint64_t prefixXor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+} // namespace
+
+const char* CSVStructuralIndex::scanRecord(const char* pBegin, const char* pEnd,
+                                           std::vector<uint32_t>& separators) const
+{
+    separators.clear();
+    return scan(pBegin, pEnd, &separators);
+}
+
+const char* CSVStructuralIndex::findRecordEnd(const char* pBegin, const char* pEnd) const
+{
+    return scan(pBegin, pEnd, nullptr);
+}
+
+const char* CSVStructuralIndex::getImplementationName()
+{
+#if defined(CSV_INDEX_AVX2)
+    return "AVX2";
+#elif defined(CSV_INDEX_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+const char* CSVStructuralIndex::scan(const char* pBegin, const char* pEnd,
+                                     std::vector<uint32_t>* pSeparators) const
+{
+    uint64_t quoteCarry = 0; // all ones while a quoted section continues into the next block
+    for (const char* pBlock = pBegin; pBlock < pEnd; pBlock += BLOCK_SIZE) {
+        size_t nBytes = (size_t)(pEnd - pBlock);
+        BlockMasks masks;
+        if (nBytes >= BLOCK_SIZE) {
+            masks = classifyBlock(pBlock, m_delimiter);
+        } else {
+            // Never read past pEnd: the last partial block goes through a padded copy
+            char padded[BLOCK_SIZE];
+            memcpy(padded, pBlock, nBytes);
+            memset(padded + nBytes, m_delimiter == ' ' ? '\0' : ' ', BLOCK_SIZE - nBytes);
+            masks = classifyBlock(padded, m_delimiter);
+        }
+
+        uint64_t inQuotes = prefixXor(masks.quotes) ^ quoteCarry;
+        quoteCarry = (uint64_t)((int64_t)inQuotes >> 63);
+        uint64_t newlines = masks.newlines & ~inQuotes;
+        uint64_t structural = (masks.delimiters & ~inQuotes) | newlines;
+        if (pSeparators == nullptr) {
+            structural = newlines;
+        }
+
+        while (structural != 0) {
+            int bit = std::countr_zero(structural);
+            uint32_t offset = (uint32_t)(pBlock - pBegin) + (uint32_t)bit;
+            if (pSeparators != nullptr) {
+                pSeparators->push_back(offset);
+            }
+            if ((newlines >> bit) & 1) {
+                return pBegin + offset + 1;
+            }
+            structural &= structural - 1;
+        }
+    }
+
+    if (pSeparators != nullptr) {
+        pSeparators->push_back((uint32_t)(pEnd - pBegin));
+    }
+    return pEnd;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class CSVStructuralIndex
+ * @brief Vectorized scanner that finds the field separators of a CSV record
+ *
+ * The input is processed 64 bytes at a time: SIMD compares (AVX2 or SSE2,
+ * scalar fallback elsewhere) produce bitmasks of quotes, delimiters and
+ * newlines, a prefix-XOR of the quote mask yields the "inside quotes" mask,
+ * and the delimiters/newlines outside quotes are read out with bit scans.
+ * Quotes toggle quoting anywhere in a field and "" toggles twice, matching the
+ * scalar parsers. A record always starts outside quotes.
+ */
+class CSVStructuralIndex
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    explicit CSVStructuralIndex(char delimiter = ',') : m_delimiter(delimiter) {}
+
+    void setDelimiter(char delimiter) { m_delimiter = delimiter; }
+    char getDelimiter() const { return m_delimiter; }
+
+    /**
+     * @brief Find the separators of the record starting at pBegin
+     * @param pBegin Start of the record
+     * @param pEnd End of the buffer
+     * @param separators Output: offset from pBegin of every unquoted delimiter, followed
+     *        by the offset of the record terminator ('\n' or pEnd), so one entry per field
+     * @return Position after the record's terminator (or pEnd)
+     */
+    const char* scanRecord(const char* pBegin, const char* pEnd, std::vector<uint32_t>& separators) const;
+
+    /**
+     * @brief Find the end of the record starting at pBegin
+     * @return Position after the record's terminator (or pEnd)
+     */
+    const char* findRecordEnd(const char* pBegin, const char* pEnd) const;
+
+    /**
+     * @brief Name of the compiled-in block scanner ("AVX2", "SSE2" or "scalar")
+     */
+    static const char* getImplementationName();
+
+private:
+    char m_delimiter;
+
+    const char* scan(const char* pBegin, const char* pEnd, std::vector<uint32_t>* pSeparators) const;
+};
@@ -1,30 +1,39 @@
 #include "DataCollector.h"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 
-DataCollector::DataCollector(const std::string& outputFile, const std::string& sRowVariableName)
+DataCollector::DataCollector(const std::string& outputFile, const std::string& sRowVariableName, Mode mode)
     : m_outputFile(outputFile)
     , m_sRowVariableName(sRowVariableName)
+    , m_mode(mode)
 {
 }
 
 DataCollector::~DataCollector()
 {
-    if (m_hasCurrentRow || m_rows.size() > m_savedRowCount)
+    if (m_rowValues.size() > m_savedRowCount)
         save();
+
+    if (m_saveThread.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_bQuit = true;
+        }
+        m_cv.notify_all();
+        m_saveThread.join();
+    }
 }
 
 void DataCollector::notifyNewRow(double fValue)
 {
-    if (m_hasCurrentRow)
-        finalizeCurrentRow();
-
-    // Start new row: slot 0 = row variable, slots 1..N = columns (filled with inherited values)
-    m_currentRow.clear();
-    m_currentRow.reserve(1 + m_columnOrder.size());
-    m_currentRow.push_back(fValue);
-    for (size_t i = 0; i < m_columnOrder.size(); ++i)
-        m_currentRow.push_back(m_lastValues[i]);
+    // Start new row: every column inherits its value from the previous row
+    m_rowValues.push_back(fValue);
+    for (auto& column : m_columns) {
+        double fLast = column.values.empty() ? column.fReleased : column.values.back();
+        column.values.push_back(fLast);
+    }
 
     m_hasCurrentRow = true;
 }
@@ -34,99 +43,179 @@ void DataCollector::notifyColumnValue(const std::string& sName, double fValue)
     if (!m_hasCurrentRow)
         return;
 
+    notifyColumnValue(registerColumn(sName), fValue);
+}
+
+DataCollector::ColumnId DataCollector::registerColumn(const std::string& sName)
+{
     auto it = m_columnIndex.find(sName);
-    if (it == m_columnIndex.end()) {
-        // New column discovered
-        size_t idx = m_columnOrder.size();
-        m_columnOrder.push_back(sName);
-        m_columnIndex[sName] = idx;
-        m_lastValues.push_back(0.0);
-
-        // Expand all existing finalized rows with 0.0 for this new column
-        for (auto& row : m_rows)
-            row.push_back(0.0);
-
-        // Expand current row
-        m_currentRow.push_back(fValue);
-    } else {
-        // Slot index in m_currentRow is columnIndex + 1 (slot 0 is the row variable)
-        m_currentRow[it->second + 1] = fValue;
+    if (it != m_columnIndex.end())
+        return it->second;
+
+    // New column: its storage starts at the current row, or the next one if none is open
+    ColumnId id = m_columns.size();
+    m_columnIndex[sName] = id;
+    Column& column = m_columns.emplace_back();
+    column.sName    = sName;
+    column.startRow = m_rowValues.size();
+    if (m_hasCurrentRow) {
+        column.startRow--;
+        column.values.push_back(0.0);
     }
+    return id;
+}
+
+void DataCollector::notifyColumnValue(ColumnId id, double fValue)
+{
+    if (!m_hasCurrentRow || id >= m_columns.size())
+        return;
+
+    m_columns[id].values.back() = fValue;
 }
 
 void DataCollector::save()
 {
-    if (m_hasCurrentRow)
-        finalizeCurrentRow();
+    // The current row is complete from here on; later values need a new row
+    m_hasCurrentRow = false;
 
-    if (m_rows.empty())
+    if (m_rowValues.empty())
         return;
 
-    bool newColumns = (m_columnOrder.size() != m_columnCountAtLastSave);
+    bool newColumns = (m_columns.size() != m_columnCountAtLastSave);
+
+    // Rows already released can't be rewritten with the new header
+    if (newColumns && m_bWritten && m_mode == Mode::Streaming)
+        m_segmentIndex++;
 
-    if (newColumns || m_savedRowCount == 0) {
-        writeAllRows();
-    } else if (m_rows.size() > m_savedRowCount) {
-        appendRows(m_savedRowCount);
+    // The save thread owns m_job until it is done with the previous save
+    waitForSave();
+    bool   bRewrite = newColumns || !m_bWritten;
+    size_t fromRow  = bRewrite ? 0 : m_savedRowCount;
+    if (fromRow == m_rowValues.size())
+        return;
+
+    m_job.sPath     = getSegmentPath(m_segmentIndex);
+    m_job.bTruncate = bRewrite;
+    m_job.header.clear();
+    if (m_job.bTruncate) {
+        m_job.header.push_back(m_sRowVariableName);
+        for (const auto& column : m_columns)
+            m_job.header.push_back(column.sName);
     }
 
-    m_savedRowCount         = m_rows.size();
-    m_columnCountAtLastSave = m_columnOrder.size();
+    m_bWritten              = true;
+    m_columnCountAtLastSave = m_columns.size();
+    takeSnapshot(m_job, fromRow);
+
+    if (!m_saveThread.joinable())
+        m_saveThread = std::thread(&DataCollector::saveFunction, this);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_bJobPending = true;
+    }
+    m_cv.notify_all();
+}
+
+void DataCollector::waitForSave()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return !m_bJobPending; });
+}
+
+std::string DataCollector::getSegmentPath(size_t segment) const
+{
+    if (segment == 0)
+        return m_outputFile;
+
+    std::filesystem::path path(m_outputFile);
+    std::string sName = path.stem().string() + "_" + std::to_string(segment) + path.extension().string();
+    return (path.parent_path() / sName).string();
 }
 
 // --- private ---
 
-void DataCollector::finalizeCurrentRow()
+double DataCollector::getValue(const Column& column, size_t row) const
 {
-    if (!m_hasCurrentRow)
+    return row < column.startRow ? 0.0 : column.values[row - column.startRow];
+}
+
+void DataCollector::takeSnapshot(SaveJob& job, size_t fromRow)
+{
+    job.columns.resize(m_columns.size());
+
+    if (m_mode == Mode::Streaming) {
+        // Everything buffered is written; swap it out against the job's emptied
+        // buffers, keeping each column's last value for inheritance
+        job.rowValues.swap(m_rowValues);
+        for (size_t i = 0; i < m_columns.size(); ++i) {
+            Column& column = m_columns[i];
+            if (!column.values.empty())
+                column.fReleased = column.values.back();
+            job.columns[i].startRow = column.startRow;
+            job.columns[i].values.swap(column.values);
+            column.startRow = 0;
+        }
+        m_releasedRowCount += job.rowValues.size();
+        m_savedRowCount = 0;
         return;
+    }
 
-    // Update inheritance vector
-    for (size_t i = 0; i < m_columnOrder.size(); ++i)
-        m_lastValues[i] = m_currentRow[i + 1];
+    job.rowValues.assign(m_rowValues.begin() + fromRow, m_rowValues.end());
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        const Column& column = m_columns[i];
+        size_t start = std::max(column.startRow, fromRow);
+        job.columns[i].startRow = start - fromRow;
+        job.columns[i].values.assign(column.values.begin() + (start - column.startRow), column.values.end());
+    }
+    m_savedRowCount = m_rowValues.size();
+}
 
-    m_rows.push_back(std::move(m_currentRow));
-    m_hasCurrentRow = false;
+void DataCollector::saveFunction()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [this] { return m_bJobPending || m_bQuit; });
+        if (!m_bJobPending)
+            break; // quit with nothing left to write
+
+        lock.unlock();
+        writeJob(m_job);
+        // Empty the buffers but keep their capacity for the next swap
+        m_job.rowValues.clear();
+        for (auto& column : m_job.columns)
+            column.values.clear();
+        lock.lock();
+
+        m_bJobPending = false;
+        m_cv.notify_all();
+    }
 }
 
-void DataCollector::writeAllRows()
+void DataCollector::writeJob(const SaveJob& job) const
 {
-    std::ofstream f(m_outputFile, std::ios::trunc);
+    std::ofstream f(job.sPath, job.bTruncate ? std::ios::trunc : std::ios::app);
     if (!f.is_open())
         return;
 
-    f << std::fixed << std::setprecision(m_precision);
-
-    // Header
-    f << m_sRowVariableName;
-    for (const auto& col : m_columnOrder)
-        f << ',' << col;
-    f << '\n';
-
-    // Data
-    for (const auto& row : m_rows) {
-        for (size_t i = 0; i < row.size(); ++i) {
+    if (job.bTruncate) {
+        for (size_t i = 0; i < job.header.size(); ++i) {
             if (i > 0) f << ',';
-            f << row[i];
+            f << job.header[i];
         }
         f << '\n';
     }
+
+    writeRows(f, job);
 }
 
-void DataCollector::appendRows(size_t fromRow)
+void DataCollector::writeRows(std::ostream& f, const SaveJob& job) const
 {
-    std::ofstream f(m_outputFile, std::ios::app);
-    if (!f.is_open())
-        return;
-
     f << std::fixed << std::setprecision(m_precision);
 
-    for (size_t r = fromRow; r < m_rows.size(); ++r) {
-        const auto& row = m_rows[r];
-        for (size_t i = 0; i < row.size(); ++i) {
-            if (i > 0) f << ',';
-            f << row[i];
-        }
+    for (size_t r = 0; r < job.rowValues.size(); ++r) {
+        f << job.rowValues[r];
+        for (const auto& column : job.columns)
+            f << ',' << getValue(column, r);
         f << '\n';
     }
 }
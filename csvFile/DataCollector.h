@@ -1,6 +1,10 @@
 #pragma once
 
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -10,45 +14,126 @@
  *
  * Callers drive rows via notifyNewRow() and push named column values via
  * notifyColumnValue(). Columns are discovered dynamically in first-seen order.
+ * Hot loops register their columns once with registerColumn() and push by
+ * ColumnId, which skips the name lookup.
  * Missing values inherit from the previous row. Call save() periodically or
  * let the destructor handle it.
+ *
+ * Storage is columnar: one contiguous array per column, starting at the row
+ * where the column was first seen. Rows before that read as 0, so
+ * discovering a column never touches earlier rows.
+ *
+ * In Mode::InMemory every row stays in memory and a save() after a new column
+ * appeared rewrites the whole file. In Mode::Streaming each save() appends the
+ * new rows and then releases them, so memory is bounded by the rows between
+ * saves. A new column cannot be added to rows already on disk; instead the
+ * next save() starts a new segment file with the full header (see
+ * getSegmentPath()). Every segment is a complete CSV file.
+ *
+ * save() only copies the rows to write (Mode::Streaming swaps its buffers
+ * instead) and hands them to a background thread that formats and writes
+ * them; waitForSave() blocks until that is done. A save() while the previous
+ * one is still being written waits for it first. The destructor saves the
+ * remaining rows and waits for the thread.
  */
 class DataCollector
 {
 public:
-    DataCollector(const std::string& outputFile, const std::string& sRowVariableName);
+    using ColumnId = size_t;
+
+    enum class Mode
+    {
+        InMemory,      ///< Keep all rows; a schema change rewrites the file
+        Streaming      ///< Release rows once saved; a schema change starts a new segment
+    };
+
+    DataCollector(const std::string& outputFile, const std::string& sRowVariableName,
+                  Mode mode = Mode::InMemory);
     ~DataCollector();
 
     void notifyNewRow(double fValue);
     void notifyColumnValue(const std::string& sName, double fValue);
+
+    /**
+     * @brief Get the id of a column, adding it (in registration order) if it is new
+     *
+     * Rows before registration read as 0. Ids stay valid for the collector's lifetime.
+     */
+    ColumnId registerColumn(const std::string& sName);
+
+    /**
+     * @brief Set a column of the current row by id (ignored without a current row)
+     */
+    void notifyColumnValue(ColumnId id, double fValue);
     void save();
 
-    size_t getRowCount() const { return m_rows.size() + (m_hasCurrentRow ? 1 : 0); }
+    /**
+     * @brief Block until the rows of every save() so far are written
+     */
+    void waitForSave();
+
+    size_t getRowCount() const { return m_releasedRowCount + m_rowValues.size(); }
+
+    /**
+     * @brief Number of files written so far (more than 1 only in Mode::Streaming)
+     */
+    size_t getSegmentCount() const { return m_segmentIndex + (m_bWritten ? 1 : 0); }
+
+    /**
+     * @brief Path of a segment file: the output file for segment 0, "<stem>_<n><ext>" after that
+     */
+    std::string getSegmentPath(size_t segment) const;
 
 private:
-    void finalizeCurrentRow();
-    void writeAllRows();
-    void appendRows(size_t fromRow);
+    struct Column
+    {
+        std::string         sName;
+        size_t              startRow = 0;   // first buffered row with a stored value
+        std::vector<double> values;         // values of buffered rows startRow..end
+        double              fReleased = 0;  // value of the last released row (inheritance)
+    };
+
+    // Rows handed to the save thread, self-contained so the caller can keep collecting
+    struct SaveJob
+    {
+        std::string              sPath;
+        bool                     bTruncate = false;   // write the header first, else append
+        std::vector<std::string> header;              // row variable and column names
+        std::vector<double>      rowValues;
+        std::vector<Column>      columns;             // startRow is relative to rowValues
+    };
+
+    double getValue(const Column& column, size_t row) const;
+    void takeSnapshot(SaveJob& job, size_t fromRow);
+    void saveFunction();
+    void writeJob(const SaveJob& job) const;
+    void writeRows(std::ostream& f, const SaveJob& job) const;
 
     std::string m_outputFile;
     std::string m_sRowVariableName;
+    Mode        m_mode;
 
-    // Column tracking (excludes the row variable, which is always column 0)
-    std::vector<std::string>                 m_columnOrder;
+    // Columns in first-seen order (excludes the row variable, which is always column 0)
+    std::vector<Column>                      m_columns;
     std::unordered_map<std::string, size_t>  m_columnIndex;
 
-    // Buffered data — each inner vector is [rowValue, col0, col1, ...]
-    std::vector<std::vector<double>> m_rows;
-
-    // Current (in-progress) row
-    std::vector<double> m_currentRow;
+    // Row variable per buffered row; the last row is the current one while m_hasCurrentRow
+    std::vector<double> m_rowValues;
     bool                m_hasCurrentRow = false;
 
-    // Inheritance: last known value per column
-    std::vector<double> m_lastValues;
-
     // Save bookkeeping
-    size_t m_savedRowCount          = 0;
+    size_t m_savedRowCount          = 0;   // buffered rows already on disk
+    size_t m_releasedRowCount       = 0;   // rows saved and dropped from memory (Mode::Streaming)
+    size_t m_segmentIndex           = 0;   // segment file currently written
+    bool   m_bWritten               = false;
     size_t m_columnCountAtLastSave  = 0;
     int    m_precision              = 6;
+
+    // Save thread hand-off
+    SaveJob                 m_job;                  // owned by the save thread while m_bJobPending
+    bool                    m_bJobPending = false;
+    bool                    m_bQuit       = false;
+    std::mutex              m_mutex;                // guards m_bJobPending and m_bQuit
+    std::condition_variable m_cv;
+    std::thread             m_saveThread;
 };
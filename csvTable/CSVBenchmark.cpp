@@ -0,0 +1,461 @@
+#include "CSVBenchmark.h"
+#include "CSVColumnCache.h"
+#include "CSVTypedTable.h"
+#include "utils/csvFile/CSVFileReader.h"
+#include "utils/csvFile/CSVFileWriter.h"
+#include "utils/csvFile/CSVMappedReader.h"
+#include "utils/csvFile/CSVParallelReader.h"
+#include "utils/csvFile/DataCollector.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#ifdef _WIN32
+#include "utils/fileUtils/WindowsCompat.h"
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr uint64_t DATA_SEED = 0xC5F11E;
+constexpr size_t ROW_POOL = 1024;             // distinct rows, repeated to reach the target size
+constexpr size_t SAVE_INTERVAL_ROWS = 10000;  // DataCollector::save() cadence
+constexpr int NUMBER_DECIMALS = 6;
+constexpr size_t NUMBER_CHARS = 64;
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+
+struct DatasetSpec
+{
+    const char* name;
+    size_t nTextColumns;
+    size_t nNumericColumns;
+    double fMagnitude;                         // numbers are uniform in [0, fMagnitude)
+};
+
+const DatasetSpec DATASETS[] = {
+    { "numeric", 0, 16, 1e4 },
+    { "quoted", 2, 4, 1e3 },
+    { "wide", 0, 512, 1e2 },
+    { "tall", 0, 3, 1e2 },
+};
+
+const char* const APPLICATIONS[] = { "game.exe", "My, App.exe", "\"quoted\".exe", "dwm.exe" };
+const char* const WORDS[] = { "frame", "present", "\"flip\"", "gpu, busy", "vsync", "late" };
+
+/**
+ * Rows of a dataset, both as values and as fields ready for CSV text
+ */
+struct RowPool
+{
+    std::vector<std::string> headers;
+    std::vector<std::vector<double>> numbers;  // numeric columns only
+    std::vector<std::vector<std::string>> fields;
+    size_t nBytesPerRow = 0;                  // average CSV line length
+};
+
+const DatasetSpec* findDataset(const std::string& sDataset)
+{
+    for (const DatasetSpec& spec : DATASETS) {
+        if (sDataset == spec.name) {
+            return &spec;
+        }
+    }
+    return nullptr;
+}
+
+std::string formatNumber(double fValue)
+{
+    char buffer[NUMBER_CHARS];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), fValue, std::chars_format::fixed, NUMBER_DECIMALS);
+    return std::string(buffer, result.ptr);
+}
+
+std::string escapeField(const std::string& field)
+{
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        return field;
+    }
+    std::string escaped = "\"";
+    for (char c : field) {
+        escaped += c;
+        if (c == '"') {
+            escaped += '"';
+        }
+    }
+    return escaped + "\"";
+}
+
+void makeRowPool(const DatasetSpec& spec, RowPool& pool)
+{
+    std::mt19937_64 rng(DATA_SEED);
+    std::uniform_real_distribution<double> number(0.0, spec.fMagnitude);
+    std::uniform_int_distribution<size_t> application(0, std::size(APPLICATIONS) - 1);
+    std::uniform_int_distribution<size_t> word(0, std::size(WORDS) - 1);
+
+    if (spec.nTextColumns > 0) {
+        pool.headers = { "Application", "Comment" };
+    }
+    for (size_t i = 0; i < spec.nNumericColumns; ++i) {
+        pool.headers.push_back("c" + std::to_string(i));
+    }
+
+    size_t nBytes = 0;
+    for (size_t r = 0; r < ROW_POOL; ++r) {
+        std::vector<std::string>& fields = pool.fields.emplace_back();
+        std::vector<double>& numbers = pool.numbers.emplace_back();
+        if (spec.nTextColumns > 0) {
+            fields.push_back(APPLICATIONS[application(rng)]);
+            fields.push_back(std::string(WORDS[word(rng)]) + " " + WORDS[word(rng)]);
+        }
+        for (size_t i = 0; i < spec.nNumericColumns; ++i) {
+            numbers.push_back(number(rng));
+            fields.push_back(formatNumber(numbers.back()));
+        }
+        for (const std::string& field : fields) {
+            nBytes += escapeField(field).size() + 1;
+        }
+    }
+    pool.nBytesPerRow = nBytes / ROW_POOL;
+}
+
+size_t getRowCount(const RowPool& pool, size_t nBytes)
+{
+    return std::max<size_t>(1, nBytes / std::max<size_t>(1, pool.nBytesPerRow));
+}
+
+size_t getFileBytes(const std::string& sPath)
+{
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(sPath, ec);
+    return ec ? 0 : (size_t)size;
+}
+
+void resetPeakRSS()
+{
+#if defined(__linux__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";   // resets the peak resident set size
+#endif
+}
+
+size_t getPeakRSSBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;   // kilobytes on Linux
+#endif
+#endif
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+CSVThroughput makeResult(const std::string& sDataset, const char* sMode, size_t nBytes, size_t nRows, double fSec)
+{
+    CSVThroughput result;
+    result.sDataset = sDataset;
+    result.sMode = sMode;
+    result.fMBPerSec = nBytes / BYTES_PER_MB / fSec;
+    result.fRowsPerSec = nRows / fSec;
+    result.peakRSSBytes = getPeakRSSBytes();
+    return result;
+}
+
+// ---- read modes: each reads the whole file and returns the number of rows ----
+
+// Two columns for the projected/columnar modes: the first and the last
+std::vector<std::string> getProjection(const std::vector<std::string>& headers)
+{
+    return { headers.front(), headers.back() };
+}
+
+size_t readFileRows(const std::string& sPath)
+{
+    CSVFileReader reader(sPath);
+    std::vector<std::string> row;
+    size_t nRows = 0;
+    while (reader.readRow(row)) nRows++;
+    return nRows;
+}
+size_t readFileNumbers(const std::string& sPath)
+{
+    // Rows with a non-numeric field fail and are not counted
+    CSVFileReader reader(sPath);
+    std::vector<double> row;
+    size_t nRows = 0;
+    while (!reader.isEndOfFile() && reader.isValid()) {
+        if (reader.readRowAsNumbers(row)) nRows++;
+    }
+    return nRows;
+}
+size_t readFileProjected(const std::string& sPath)
+{
+    CSVFileReader reader(sPath);
+    std::vector<std::string_view> fields;
+    size_t nRows = 0;
+    if (!reader.setProjection(getProjection(reader.getHeaders()))) return 0;
+    while (reader.readProjectedRow(fields)) nRows++;
+    return nRows;
+}
+size_t readFileColumns(const std::string& sPath)
+{
+    CSVFileReader reader(sPath);
+    std::vector<std::vector<double>> columns;
+    return reader.readColumns(getProjection(reader.getHeaders()), columns);
+}
+size_t readMappedRows(const std::string& sPath)
+{
+    CSVMappedReader reader(sPath);
+    std::vector<std::string_view> fields;
+    size_t nRows = 0;
+    while (reader.readRow(fields)) nRows++;
+    return nRows;
+}
+size_t readMappedColumns(const std::string& sPath)
+{
+    CSVMappedReader reader(sPath);
+    std::vector<std::vector<double>> columns;
+    return reader.readColumns(getProjection(reader.getHeaders()), columns);
+}
+size_t readParallelRows(const std::string& sPath)
+{
+    CSVParallelReader reader(sPath);
+    std::vector<std::vector<std::string>> rows;
+    return reader.readAllRows(rows);
+}
+size_t readParallelColumns(const std::string& sPath)
+{
+    CSVParallelReader reader(sPath);
+    std::vector<std::vector<double>> columns;
+    return reader.readColumns(getProjection(reader.getHeaders()), columns);
+}
+size_t readColumnCache(const std::string& sPath)
+{
+    CSVMappedReader header(sPath);
+    CSVColumnCache cache;
+    return cache.open(sPath, getProjection(header.getHeaders())) ? cache.getRowCount() : 0;
+}
+size_t readColumnCacheCold(const std::string& sPath)
+{
+    std::error_code ec;
+    std::filesystem::remove(CSVColumnCache::getCachePath(sPath), ec);
+    return readColumnCache(sPath);
+}
+size_t readTypedTable(const std::string& sPath)
+{
+    CSVTypedTable table;
+    return table.read(sPath) ? table.getRowCount() : 0;
+}
+
+struct ReadEntry { size_t (*fn)(const std::string&); const char* name; };
+const ReadEntry READS[] = {
+    { readFileRows,          "CSVFileReader::readRow" },
+    { readFileNumbers,       "CSVFileReader::readRowAsNumbers" },
+    { readFileProjected,     "CSVFileReader::readProjectedRow[2]" },
+    { readFileColumns,       "CSVFileReader::readColumns[2]" },
+    { readMappedRows,        "CSVMappedReader::readRow" },
+    { readMappedColumns,     "CSVMappedReader::readColumns[2]" },
+    { readParallelRows,      "CSVParallelReader::readAllRows" },
+    { readParallelColumns,   "CSVParallelReader::readColumns[2]" },
+    { readColumnCacheCold,   "CSVColumnCache::open[cold]" },
+    { readColumnCache,       "CSVColumnCache::open[warm]" },
+    { readTypedTable,        "CSVTypedTable::read" },
+};
+
+// ---- write modes: each writes nRows rows of the pool and returns the rows written ----
+
+size_t writeFile(const RowPool& pool, const std::string& sPath, size_t nRows, CSVFileWriter::Mode mode)
+{
+    CSVFileWriter writer(sPath, pool.headers, mode);
+    bool bNumeric = pool.numbers[0].size() == pool.headers.size();
+    for (size_t r = 0; r < nRows; ++r) {
+        if (bNumeric) {
+            writer.addRow(pool.numbers[r % ROW_POOL]);
+        } else {
+            writer.addRow(pool.fields[r % ROW_POOL]);
+        }
+    }
+    return nRows;
+}
+size_t writeLineFlushed(const RowPool& pool, const std::string& sPath, size_t nRows)
+{
+    return writeFile(pool, sPath, nRows, CSVFileWriter::Mode::LineFlushed);
+}
+size_t writeBuffered(const RowPool& pool, const std::string& sPath, size_t nRows)
+{
+    return writeFile(pool, sPath, nRows, CSVFileWriter::Mode::Buffered);
+}
+size_t writeAsync(const RowPool& pool, const std::string& sPath, size_t nRows)
+{
+    return writeFile(pool, sPath, nRows, CSVFileWriter::Mode::Async);
+}
+size_t writeCollector(const RowPool& pool, const std::string& sPath, size_t nRows, DataCollector::Mode mode)
+{
+    // Numeric datasets only: the first column is the row variable
+    if (pool.numbers[0].size() != pool.headers.size()) {
+        return 0;
+    }
+    DataCollector collector(sPath, pool.headers[0], mode);
+    std::vector<DataCollector::ColumnId> ids;
+    for (size_t i = 1; i < pool.headers.size(); ++i) {
+        ids.push_back(collector.registerColumn(pool.headers[i]));
+    }
+    for (size_t r = 0; r < nRows; ++r) {
+        const std::vector<double>& row = pool.numbers[r % ROW_POOL];
+        collector.notifyNewRow(row[0]);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            collector.notifyColumnValue(ids[i], row[i + 1]);
+        }
+        if ((r + 1) % SAVE_INTERVAL_ROWS == 0) {
+            collector.save();
+        }
+    }
+    collector.save();
+    collector.waitForSave();
+    return nRows;
+}
+size_t writeCollectorInMemory(const RowPool& pool, const std::string& sPath, size_t nRows)
+{
+    return writeCollector(pool, sPath, nRows, DataCollector::Mode::InMemory);
+}
+size_t writeCollectorStreaming(const RowPool& pool, const std::string& sPath, size_t nRows)
+{
+    return writeCollector(pool, sPath, nRows, DataCollector::Mode::Streaming);
+}
+
+struct WriteEntry { size_t (*fn)(const RowPool&, const std::string&, size_t); const char* name; };
+const WriteEntry WRITES[] = {
+    { writeLineFlushed,        "CSVFileWriter[LineFlushed]" },
+    { writeBuffered,           "CSVFileWriter[Buffered]" },
+    { writeAsync,              "CSVFileWriter[Async]" },
+    { writeCollectorInMemory,  "DataCollector[InMemory]" },
+    { writeCollectorStreaming, "DataCollector[Streaming]" },
+};
+
+} // namespace
+
+std::vector<std::string> CSVBenchmark::getDatasetNames()
+{
+    std::vector<std::string> names;
+    for (const DatasetSpec& spec : DATASETS) {
+        names.push_back(spec.name);
+    }
+    return names;
+}
+
+bool CSVBenchmark::generate(const std::string& sDataset, const std::string& sPath, size_t nBytes)
+{
+    const DatasetSpec* pSpec = findDataset(sDataset);
+    if (pSpec == nullptr) {
+        return false;
+    }
+    RowPool pool;
+    makeRowPool(*pSpec, pool);
+
+    // Pre-escaped lines, so generation doesn't depend on the writer under test
+    std::vector<std::string> lines;
+    for (const std::vector<std::string>& fields : pool.fields) {
+        std::string& line = lines.emplace_back();
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (i > 0) line += ',';
+            line += escapeField(fields[i]);
+        }
+        line += '\n';
+    }
+
+    std::ofstream out(sPath, std::ios::binary | std::ios::trunc);
+    for (size_t i = 0; i < pool.headers.size(); ++i) {
+        out << (i > 0 ? "," : "") << pool.headers[i];
+    }
+    out << '\n';
+    size_t nRows = getRowCount(pool, nBytes);
+    for (size_t r = 0; r < nRows; ++r) {
+        out << lines[r % ROW_POOL];
+    }
+    return out.good();
+}
+
+std::vector<CSVThroughput> CSVBenchmark::measureReads(const std::string& sDataset, const std::string& sPath)
+{
+    std::vector<CSVThroughput> results;
+    size_t nBytes = getFileBytes(sPath);
+    for (const ReadEntry& entry : READS) {
+        resetPeakRSS();
+        auto start = std::chrono::steady_clock::now();
+        size_t nRows = entry.fn(sPath);
+        results.push_back(makeResult(sDataset, entry.name, nBytes, nRows, secondsSince(start)));
+    }
+    std::error_code ec;
+    std::filesystem::remove(CSVColumnCache::getCachePath(sPath), ec);
+    return results;
+}
+
+std::vector<CSVThroughput> CSVBenchmark::measureWrites(const std::string& sDataset, const std::string& sPath,
+                                                       size_t nBytes)
+{
+    std::vector<CSVThroughput> results;
+    const DatasetSpec* pSpec = findDataset(sDataset);
+    if (pSpec == nullptr) {
+        return results;
+    }
+    RowPool pool;
+    makeRowPool(*pSpec, pool);
+    size_t nRows = getRowCount(pool, nBytes);
+
+    for (const WriteEntry& entry : WRITES) {
+        resetPeakRSS();
+        auto start = std::chrono::steady_clock::now();
+        size_t nWritten = entry.fn(pool, sPath, nRows);
+        double fSec = secondsSince(start);
+        if (nWritten > 0) {
+            results.push_back(makeResult(sDataset, entry.name, getFileBytes(sPath), nWritten, fSec));
+        }
+        std::error_code ec;
+        std::filesystem::remove(sPath, ec);
+    }
+    return results;
+}
+
+void CSVBenchmark::run(std::ostream& out, const std::string& sDirectory, size_t nBytes)
+{
+    out << "CSV throughput (MB/s, rows/s, peak RSS MB):\n";
+    for (const std::string& sDataset : getDatasetNames()) {
+        std::string sPath = (std::filesystem::path(sDirectory) / ("csvBenchmark_" + sDataset + ".csv")).string();
+        std::string sWritePath = (std::filesystem::path(sDirectory) / ("csvBenchmark_" + sDataset + "_out.csv")).string();
+        if (!generate(sDataset, sPath, nBytes)) {
+            out << "  " << sDataset << ": can't write " << sPath << "\n";
+            continue;
+        }
+
+        std::vector<CSVThroughput> results = measureReads(sDataset, sPath);
+        for (const CSVThroughput& result : measureWrites(sDataset, sWritePath, nBytes)) {
+            results.push_back(result);
+        }
+        for (const CSVThroughput& result : results) {
+            out << "  " << result.sDataset << " " << result.sMode << ": " << result.fMBPerSec << ", "
+                << result.fRowsPerSec << ", " << result.peakRSSBytes / BYTES_PER_MB << "\n";
+        }
+
+        std::error_code ec;
+        std::filesystem::remove(sPath, ec);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct CSVThroughput
+{
+    std::string sDataset;
+    std::string sMode;           // reader/writer and method under test
+    double fMBPerSec = 0.0;      // file bytes (MiB) per second
+    double fRowsPerSec = 0.0;
+    size_t peakRSSBytes = 0;     // process peak resident set after the measurement
+};
+
+/**
+ * Read and write throughput of the CSV classes in csvFile/ and csvTable/.
+ * 
+ * Synthetic files are generated per dataset:
+ *   - numeric: 16 double columns
+ *   - quoted:  2 text columns with delimiters and escaped quotes, 4 double columns
+ *   - wide:    512 double columns
+ *   - tall:    3 short numeric columns
+ * and every read mode (CSVFileReader, CSVMappedReader, CSVParallelReader,
+ * CSVColumnCache cold and warm, CSVTypedTable) and write mode (CSVFileWriter
+ * per Mode, DataCollector per Mode) is timed on them.
+ * 
+ * Peak RSS is the process high-water mark. It is reset before every
+ * measurement where the OS allows it (Linux /proc/self/clear_refs); elsewhere
+ * it only ever grows, so it is an upper bound for the later measurements.
+ * 
+ * Usage:
+ *   CSVBenchmark::run(std::cout, "D:/temp");   // writes and deletes files there
+ */
+class CSVBenchmark
+{
+public:
+    static constexpr size_t DEFAULT_DATASET_BYTES = 64 << 20;
+
+    /**
+     * Names of the synthetic datasets, for generate().
+     */
+    static std::vector<std::string> getDatasetNames();
+
+    /**
+     * Write a synthetic CSV file of roughly nBytes.
+     * 
+     * @return false if the dataset is unknown or the file can't be written
+     */
+    static bool generate(const std::string& sDataset, const std::string& sPath, size_t nBytes);
+
+    /**
+     * Time every read mode on an existing CSV file (e.g. one from generate()).
+     */
+    static std::vector<CSVThroughput> measureReads(const std::string& sDataset, const std::string& sPath);
+
+    /**
+     * Time every write mode writing roughly nBytes of a dataset to sPath.
+     */
+    static std::vector<CSVThroughput> measureWrites(const std::string& sDataset, const std::string& sPath,
+                                                    size_t nBytes);
+
+    /**
+     * Generate each dataset in sDirectory, measure reads and writes, write a
+     * report to out and delete the files.
+     */
+    static void run(std::ostream& out, const std::string& sDirectory, size_t nBytes = DEFAULT_DATASET_BYTES);
+};
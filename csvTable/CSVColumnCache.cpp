@@ -0,0 +1,241 @@
+#include "CSVColumnCache.h"
+#include "utils/csvFile/CSVParallelReader.h"
+#include "utils/serialization/BinarySerializer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x43434F4C;     // "LOCC"
+constexpr uint32_t CACHE_END_MAGIC = 0x444E4543; // "CEND"
+constexpr uint32_t CACHE_VERSION = 2;
+constexpr uint32_t MAX_COLUMNS = 1u << 16;       // rejects corrupted column counts before allocating
+const char* const CACHE_EXTENSION = ".colcache";
+const char* const TEMP_EXTENSION = ".tmp";
+
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool contains(const std::vector<std::string>& names, const std::string& name)
+{
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+bool readNames(serialization::BinarySerializer& serializer, std::vector<std::string>& names)
+{
+    uint32_t nNames = 0;
+    serializer.serialize(nNames);
+    if (!serializer.good() || nNames > MAX_COLUMNS) {
+        return false;
+    }
+    names.resize(nNames);
+    for (std::string& name : names) {
+        serializer.serialize(name);
+    }
+    return serializer.good();
+}
+
+void writeNames(serialization::BinarySerializer& serializer, const std::vector<std::string>& names)
+{
+    uint32_t nNames = (uint32_t)names.size();
+    serializer.serialize(nNames);
+    for (std::string name : names) {
+        serializer.serialize(name);
+    }
+}
+
+} // namespace
+
+bool CSVColumnCache::open(const std::string& csvPath, const std::vector<std::string>& columnNames,
+                          char delimiter, char commentChar)
+{
+    close();
+
+    FileStamp stamp;
+    if (!FileStamp::read(csvPath, stamp)) {
+        return false;
+    }
+
+    std::string cachePath = getCachePath(csvPath);
+    std::vector<std::string> cachedNames;
+    if (loadCache(cachePath, stamp, delimiter, commentChar, columnNames, cachedNames)) {
+        m_bFromCache = true;
+        return true;
+    }
+
+    // Keep the columns the cache already had, so callers with different columns don't evict each other
+    for (const std::string& name : columnNames) {
+        if (!contains(cachedNames, name)) {
+            cachedNames.push_back(name);
+        }
+    }
+    if (!parseSource(csvPath, delimiter, commentChar, cachedNames)) {
+        close();
+        return false;
+    }
+    // The cache is an optimization; a read-only folder just means parsing next time too
+    writeCache(cachePath, stamp, delimiter, commentChar);
+    return true;
+}
+
+void CSVColumnCache::close()
+{
+    m_columns.clear();
+    m_parsed.clear();
+    m_headers.clear();
+    m_names.clear();
+    m_mapping.close();
+    m_nRows = 0;
+    m_bFromCache = false;
+}
+
+std::span<const double> CSVColumnCache::getColumn(const std::string& name) const
+{
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        if (m_names[i] == name) {
+            return m_columns[i];
+        }
+    }
+    return {};
+}
+
+std::string CSVColumnCache::getCachePath(const std::string& csvPath)
+{
+    return csvPath + CACHE_EXTENSION;
+}
+
+bool CSVColumnCache::loadCache(const std::string& cachePath, const FileStamp& stamp, char delimiter,
+                               char commentChar, const std::vector<std::string>& columnNames,
+                               std::vector<std::string>& cachedNames)
+{
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    serialization::BinarySerializer serializer(in);
+    if (!serializer.serializeSentinel(CACHE_MAGIC)) {
+        return false;
+    }
+    uint32_t uVersion = 0;
+    uint64_t uSize = 0, nRows = 0;
+    int64_t mtime = 0;
+    uint8_t uDelimiter = 0, uCommentChar = 0;
+    serializer.serialize(uVersion);
+    serializer.serialize(uSize);
+    serializer.serialize(mtime);
+    serializer.serialize(uDelimiter);
+    serializer.serialize(uCommentChar);
+    serializer.serialize(nRows);
+    if (!serializer.good() || uVersion != CACHE_VERSION || uSize != stamp.size || mtime != stamp.mtime ||
+        uDelimiter != (uint8_t)delimiter || uCommentChar != (uint8_t)commentChar) {
+        return false;
+    }
+    std::vector<std::string> headers, names;
+    if (!readNames(serializer, headers) || !readNames(serializer, names) ||
+        !serializer.serializeSentinel(CACHE_END_MAGIC)) {
+        return false;
+    }
+    size_t dataOffset = alignUp((size_t)in.tellg(), DATA_ALIGNMENT);
+    in.close();
+
+    // A requested column of the source that the cache lacks means parsing again
+    for (const std::string& name : columnNames) {
+        if (contains(headers, name) && !contains(names, name)) {
+            cachedNames = std::move(names);
+            return false;
+        }
+    }
+
+    // Bound nRows by the file size before any product, so a corrupt count can't overflow the check
+    if (!m_mapping.open(cachePath) || dataOffset > m_mapping.size() ||
+        nRows > (m_mapping.size() - dataOffset) / sizeof(double) / std::max<size_t>(names.size(), 1)) {
+        m_mapping.close();
+        return false;
+    }
+    const double* pData = (const double*)(m_mapping.data() + dataOffset);
+    m_columns.clear();
+    for (size_t i = 0; i < names.size(); ++i) {
+        m_columns.emplace_back(pData + i * nRows, (size_t)nRows);
+    }
+    m_headers = std::move(headers);
+    m_names = std::move(names);
+    m_nRows = (size_t)nRows;
+    return true;
+}
+
+bool CSVColumnCache::parseSource(const std::string& csvPath, char delimiter, char commentChar,
+                                 const std::vector<std::string>& columnNames)
+{
+    CSVParallelReader reader(csvPath, commentChar);
+    reader.setDelimiter(delimiter);
+    if (!reader.isValid() || reader.getHeaders().empty()) {
+        return false;
+    }
+    m_headers = reader.getHeaders();
+    for (const std::string& name : columnNames) {
+        if (contains(m_headers, name) && !contains(m_names, name)) {
+            m_names.push_back(name);
+        }
+    }
+    m_nRows = reader.readColumns(m_names, m_parsed);
+    for (const std::vector<double>& column : m_parsed) {
+        m_columns.emplace_back(column);
+    }
+    return true;
+}
+
+bool CSVColumnCache::writeCache(const std::string& cachePath, const FileStamp& stamp,
+                                char delimiter, char commentChar) const
+{
+    // A private temp name, so concurrent writers never interleave into one file
+    std::string tempPath = cachePath + "." + std::to_string(std::random_device()()) + TEMP_EXTENSION;
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        serialization::BinarySerializer serializer(out);
+        serializer.serializeSentinel(CACHE_MAGIC);
+        uint32_t uVersion = CACHE_VERSION;
+        uint64_t uSize = stamp.size, nRows = m_nRows;
+        int64_t mtime = stamp.mtime;
+        uint8_t uDelimiter = (uint8_t)delimiter, uCommentChar = (uint8_t)commentChar;
+        serializer.serialize(uVersion);
+        serializer.serialize(uSize);
+        serializer.serialize(mtime);
+        serializer.serialize(uDelimiter);
+        serializer.serialize(uCommentChar);
+        serializer.serialize(nRows);
+        writeNames(serializer, m_headers);
+        writeNames(serializer, m_names);
+        serializer.serializeSentinel(CACHE_END_MAGIC);
+
+        size_t headerSize = (size_t)out.tellp();
+        std::string padding(alignUp(headerSize, DATA_ALIGNMENT) - headerSize, '\0');
+        out.write(padding.data(), (std::streamsize)padding.size());
+        for (std::span<const double> column : m_columns) {
+            out.write((const char*)column.data(), (std::streamsize)column.size_bytes());
+        }
+        if (!out.good()) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    // Readers never see a partially written cache
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "utils/fileUtils/FileStamp.h"
+#include "utils/fileUtils/MappedFile.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @class CSVColumnCache
+ * @brief Numeric columns of a CSV file, backed by a binary sidecar cache
+ *
+ * open() loads the requested columns. It looks for "<csv>.colcache" next to
+ * the CSV. If the cache exists, was built from a source with the same size,
+ * modification time, delimiter and comment char, and holds every requested
+ * column, it is memory-mapped and the columns are returned without any
+ * parsing. Otherwise only the requested columns (plus those already in the
+ * cache) are parsed from the text (CSVParallelReader), served from memory
+ * and written to a new cache for next time.
+ *
+ * Values are stored as doubles only: the cache serves numeric columns to
+ * analysis code, and typed or text columns are read with CSVTypedTable.
+ * Empty or non-numeric cells are NaN, as with CSVFileReader::readColumns().
+ * A header name that occurs more than once refers to its first column.
+ *
+ * Cache layout: a BinarySerializer header (magic, version, source size and
+ * mtime, delimiter, comment char, row count, source header row, names of the
+ * cached columns), zero padding to DATA_ALIGNMENT, then one contiguous
+ * double array per cached column.
+ */
+class CSVColumnCache
+{
+public:
+    static constexpr size_t DATA_ALIGNMENT = 64; ///< Alignment of the column arrays in the cache file
+
+    CSVColumnCache() = default;
+
+    CSVColumnCache(const CSVColumnCache&) = delete;
+    CSVColumnCache& operator=(const CSVColumnCache&) = delete;
+
+    /**
+     * @brief Load columns of a CSV file, through its cache when it is current
+     * @param csvPath The path to the CSV file
+     * @param columnNames Columns to load; names that are not in the header are skipped
+     * @param delimiter Field delimiter of the CSV file
+     * @param commentChar If non-zero, lines starting with this char are skipped
+     * @return false if neither the cache nor the CSV could be read
+     */
+    bool open(const std::string& csvPath, const std::vector<std::string>& columnNames,
+              char delimiter = ',', char commentChar = '\0');
+
+    /**
+     * @brief Release the columns and the mapping
+     */
+    void close();
+
+    /**
+     * @brief Whether the columns came from an up-to-date cache (no text parsing)
+     */
+    bool isFromCache() const { return m_bFromCache; }
+
+    /**
+     * @brief Header row of the CSV file (all columns, loaded or not)
+     */
+    const std::vector<std::string>& getHeaders() const { return m_headers; }
+    size_t getRowCount() const { return m_nRows; }
+
+    /**
+     * @brief Values of a loaded column, valid until close() or the next open()
+     * @return Empty span if the column is not in the CSV or was not loaded
+     */
+    std::span<const double> getColumn(const std::string& name) const;
+
+    /**
+     * @brief Path of the cache file for a CSV file
+     */
+    static std::string getCachePath(const std::string& csvPath);
+
+private:
+    std::vector<std::string> m_headers;            ///< Header row of the source
+    std::vector<std::string> m_names;              ///< Names of the loaded columns
+    size_t m_nRows = 0;                            ///< Rows per column
+    MappedFile m_mapping;                          ///< Cache file, when the columns come from it
+    std::vector<std::vector<double>> m_parsed;     ///< Columns parsed from text otherwise
+    std::vector<std::span<const double>> m_columns; ///< Per loaded column, a view into either of the above
+    bool m_bFromCache = false;
+
+    /**
+     * @brief Map the cache if its header matches the source and it has every requested column
+     * @param cachedNames Output, the columns in a matching cache (empty if none matches)
+     */
+    bool loadCache(const std::string& cachePath, const FileStamp& stamp, char delimiter, char commentChar,
+                   const std::vector<std::string>& columnNames, std::vector<std::string>& cachedNames);
+
+    /**
+     * @brief Parse the named columns from the CSV text into m_parsed
+     */
+    bool parseSource(const std::string& csvPath, char delimiter, char commentChar,
+                     const std::vector<std::string>& columnNames);
+
+    /**
+     * @brief Write the loaded columns to a new cache file, replacing any old one
+     */
+    bool writeCache(const std::string& cachePath, const FileStamp& stamp, char delimiter, char commentChar) const;
+};
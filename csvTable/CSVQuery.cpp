@@ -0,0 +1,246 @@
+#include "CSVQuery.h"
+#include "utils/csvFile/CSVMappedReader.h"
+#include "utils/csvFile/CSVNumber.h"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+namespace {
+
+constexpr size_t QUANTILE_CHARS = 32; // shortest round-trip form of any double
+
+template <typename T>
+bool compareValues(const T& a, CSVQuery::Compare compare, const T& b)
+{
+    switch (compare) {
+    case CSVQuery::Compare::Less:         return a < b;
+    case CSVQuery::Compare::LessEqual:    return a <= b;
+    case CSVQuery::Compare::Greater:      return a > b;
+    case CSVQuery::Compare::GreaterEqual: return a >= b;
+    case CSVQuery::Compare::Equal:        return a == b;
+    case CSVQuery::Compare::NotEqual:     return a != b;
+    }
+    return false;
+}
+
+const char* getAggregateName(CSVQuery::Aggregate aggregate)
+{
+    switch (aggregate) {
+    case CSVQuery::Aggregate::Count:    return "count";
+    case CSVQuery::Aggregate::Sum:      return "sum";
+    case CSVQuery::Aggregate::Mean:     return "mean";
+    case CSVQuery::Aggregate::Min:      return "min";
+    case CSVQuery::Aggregate::Max:      return "max";
+    case CSVQuery::Aggregate::Quantile: return "q";
+    }
+    return "";
+}
+
+} // namespace
+
+void CSVQuery::addFilter(const std::string& column, Compare compare, double fValue)
+{
+    m_filters.push_back({ column, compare, true, fValue, std::string(), 0 });
+}
+
+void CSVQuery::addFilter(const std::string& column, Compare compare, const std::string& value)
+{
+    m_filters.push_back({ column, compare, false, 0.0, value, 0 });
+}
+
+void CSVQuery::addGroupBy(const std::string& column)
+{
+    m_groupBy.push_back(column);
+}
+
+size_t CSVQuery::addAggregate(Aggregate aggregate, const std::string& column, double fQuantile)
+{
+    m_aggregates.push_back({ aggregate, column, fQuantile, 0 });
+    return m_aggregates.size() - 1;
+}
+
+void CSVQuery::clear()
+{
+    m_filters.clear();
+    m_groupBy.clear();
+    m_groupFields.clear();
+    m_aggregates.clear();
+    m_groups.clear();
+    m_states.clear();
+    m_groupIndex.clear();
+    m_nRowsScanned = 0;
+    m_nRowsMatched = 0;
+}
+
+bool CSVQuery::run(const std::string& csvPath, char delimiter, char commentChar)
+{
+    m_groups.clear();
+    m_states.clear();
+    m_groupIndex.clear();
+    m_nRowsScanned = 0;
+    m_nRowsMatched = 0;
+
+    CSVMappedReader reader(csvPath, commentChar);
+    reader.setDelimiter(delimiter);
+    if (!reader.isValid()) {
+        return false;
+    }
+
+    // Filter columns come first in the projection so they are parsed first
+    std::vector<std::string> columns;
+    for (Filter& filter : m_filters) {
+        filter.field = addColumn(columns, filter.column);
+    }
+    m_groupFields.clear();
+    for (const std::string& column : m_groupBy) {
+        m_groupFields.push_back(addColumn(columns, column));
+    }
+    for (AggregateSpec& spec : m_aggregates) {
+        if (!spec.column.empty()) {
+            spec.field = addColumn(columns, spec.column);
+        }
+    }
+    if (!reader.setProjection(columns)) {
+        return false;
+    }
+
+    if (m_groupBy.empty()) {
+        std::string key;
+        findGroup({}, key);
+    }
+
+    std::vector<std::string_view> fields;
+    std::string key;
+    while (reader.readProjectedRow(fields)) {
+        m_nRowsScanned++;
+        if (!passesFilters(fields)) {
+            continue;
+        }
+        m_nRowsMatched++;
+        accumulate(findGroup(fields, key), fields);
+    }
+
+    finish();
+    return true;
+}
+
+std::vector<std::string> CSVQuery::getResultHeaders() const
+{
+    std::vector<std::string> headers = m_groupBy;
+    for (const AggregateSpec& spec : m_aggregates) {
+        std::string name = getAggregateName(spec.aggregate);
+        if (spec.aggregate == Aggregate::Quantile) {
+            char buffer[QUANTILE_CHARS];
+            name.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), spec.fQuantile).ptr);
+        }
+        headers.push_back(name + "(" + spec.column + ")");
+    }
+    return headers;
+}
+
+size_t CSVQuery::addColumn(std::vector<std::string>& columns, const std::string& column)
+{
+    auto it = std::find(columns.begin(), columns.end(), column);
+    if (it != columns.end()) {
+        return (size_t)(it - columns.begin());
+    }
+    columns.push_back(column);
+    return columns.size() - 1;
+}
+
+bool CSVQuery::passesFilters(const std::vector<std::string_view>& fields) const
+{
+    for (const Filter& filter : m_filters) {
+        std::string_view field = fields[filter.field];
+        if (filter.isNumeric) {
+            double fValue;
+            if (CSVNumber::parse(field, fValue) != CSVNumber::Status::Ok ||
+                !compareValues(fValue, filter.compare, filter.fValue)) {
+                return false;
+            }
+        } else if (!compareValues(field, filter.compare, std::string_view(filter.value))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t CSVQuery::findGroup(const std::vector<std::string_view>& fields, std::string& key)
+{
+    // Length-prefixed key fields, so no value can collide with a separator
+    key.clear();
+    for (size_t field : m_groupFields) {
+        uint32_t length = (uint32_t)fields[field].size();
+        key.append((const char*)&length, sizeof(length));
+        key.append(fields[field]);
+    }
+
+    auto it = m_groupIndex.find(key);
+    if (it != m_groupIndex.end()) {
+        return it->second;
+    }
+
+    size_t index = m_groups.size();
+    m_groupIndex.emplace(key, index);
+    Group& group = m_groups.emplace_back();
+    for (size_t field : m_groupFields) {
+        group.keys.emplace_back(fields[field]);
+    }
+    std::vector<AggregateState>& states = m_states.emplace_back();
+    for (const AggregateSpec& spec : m_aggregates) {
+        AggregateState& state = states.emplace_back();
+        state.quantile = StreamingQuantile(spec.fQuantile);
+    }
+    return index;
+}
+
+void CSVQuery::accumulate(size_t group, const std::vector<std::string_view>& fields)
+{
+    m_groups[group].nRows++;
+    std::vector<AggregateState>& states = m_states[group];
+    for (size_t i = 0; i < m_aggregates.size(); ++i) {
+        const AggregateSpec& spec = m_aggregates[i];
+        AggregateState& state = states[i];
+        if (spec.column.empty()) {
+            state.nCount++;
+            continue;
+        }
+        double fValue;
+        if (CSVNumber::parse(fields[spec.field], fValue) != CSVNumber::Status::Ok) {
+            continue;
+        }
+        if (state.nCount == 0) {
+            state.fMin = state.fMax = fValue;
+        } else {
+            state.fMin = std::min(state.fMin, fValue);
+            state.fMax = std::max(state.fMax, fValue);
+        }
+        state.nCount++;
+        state.fSum += fValue;
+        if (spec.aggregate == Aggregate::Quantile) {
+            state.quantile.addSample(fValue);
+        }
+    }
+}
+
+void CSVQuery::finish()
+{
+    const double fNaN = std::numeric_limits<double>::quiet_NaN();
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        std::vector<double>& values = m_groups[g].values;
+        values.clear();
+        for (size_t i = 0; i < m_aggregates.size(); ++i) {
+            const AggregateState& state = m_states[g][i];
+            bool isEmpty = state.nCount == 0;
+            switch (m_aggregates[i].aggregate) {
+            case Aggregate::Count:    values.push_back((double)state.nCount); break;
+            case Aggregate::Sum:      values.push_back(state.fSum); break;
+            case Aggregate::Mean:     values.push_back(isEmpty ? fNaN : state.fSum / (double)state.nCount); break;
+            case Aggregate::Min:      values.push_back(isEmpty ? fNaN : state.fMin); break;
+            case Aggregate::Max:      values.push_back(isEmpty ? fNaN : state.fMax); break;
+            case Aggregate::Quantile: values.push_back(state.quantile.getQuantile()); break;
+            }
+        }
+    }
+}
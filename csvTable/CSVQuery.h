@@ -0,0 +1,160 @@
+#pragma once
+
+#include "StreamingQuantile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class CSVQuery
+ * @brief Single-pass filter / group-by / aggregate query over a CSV file
+ *
+ * Answers questions such as "mean of X grouped by Y where Z > k" without
+ * loading the file:
+ *
+ *   CSVQuery query;
+ *   query.addFilter("Z", CSVQuery::Compare::Greater, k);
+ *   query.addGroupBy("Y");
+ *   query.addAggregate(CSVQuery::Aggregate::Mean, "X");
+ *   query.run("data.csv");
+ *   for (const CSVQuery::Group& group : query.getGroups()) { ... }
+ *
+ * Only the referenced columns are parsed (CSVMappedReader projection). The
+ * filters are evaluated on the raw fields first; group keys and aggregate
+ * values are only looked at for rows that pass. Memory is bounded by the
+ * number of groups: every aggregate, including quantiles (StreamingQuantile),
+ * is updated in place.
+ *
+ * Aggregates skip empty and non-numeric values, like SQL NULLs. Count counts
+ * the rows of a group if its column name is empty and the numeric values of
+ * the column otherwise. Groups are reported in first-seen order; without
+ * group-by columns there is exactly one group.
+ */
+class CSVQuery
+{
+public:
+    enum class Compare
+    {
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual
+    };
+
+    enum class Aggregate
+    {
+        Count,
+        Sum,
+        Mean,
+        Min,
+        Max,
+        Quantile
+    };
+
+    struct Group
+    {
+        std::vector<std::string> keys;     ///< One value per group-by column
+        std::vector<double> values;        ///< One result per aggregate (NaN if it saw no values)
+        size_t nRows = 0;                  ///< Rows that passed the filters
+    };
+
+    /**
+     * @brief Keep only rows whose column compares numerically true against fValue
+     *
+     * Rows where the column is empty or not a number are dropped.
+     */
+    void addFilter(const std::string& column, Compare compare, double fValue);
+
+    /**
+     * @brief Keep only rows whose column compares true against value (byte-wise string order)
+     */
+    void addFilter(const std::string& column, Compare compare, const std::string& value);
+
+    /**
+     * @brief Group rows by the values of a column (call again for composite keys)
+     */
+    void addGroupBy(const std::string& column);
+
+    /**
+     * @brief Add an aggregate to compute per group
+     * @param column Column to aggregate (may be empty for Count)
+     * @param fQuantile Quantile in [0, 1] for Aggregate::Quantile
+     * @return Index of the result in Group::values
+     */
+    size_t addAggregate(Aggregate aggregate, const std::string& column, double fQuantile = 0.5);
+
+    /**
+     * @brief Remove all filters, group-by columns, aggregates and results
+     */
+    void clear();
+
+    /**
+     * @brief Evaluate the query over a CSV file
+     * @return false if the file can't be read or a referenced column doesn't exist
+     */
+    bool run(const std::string& csvPath, char delimiter = ',', char commentChar = '\0');
+
+    const std::vector<Group>& getGroups() const { return m_groups; }
+
+    /**
+     * @brief Names of the result columns: the group-by columns, then e.g. "mean(X)"
+     */
+    std::vector<std::string> getResultHeaders() const;
+
+    size_t getRowsScanned() const { return m_nRowsScanned; }
+    size_t getRowsMatched() const { return m_nRowsMatched; }
+
+private:
+    struct Filter
+    {
+        std::string column;
+        Compare compare;
+        bool isNumeric;
+        double fValue;
+        std::string value;
+        size_t field;                      ///< Index in the projected row
+    };
+
+    struct AggregateSpec
+    {
+        Aggregate aggregate;
+        std::string column;
+        double fQuantile;
+        size_t field;                      ///< Index in the projected row (unused for row counts)
+    };
+
+    struct AggregateState
+    {
+        size_t nCount = 0;
+        double fSum = 0;
+        double fMin = 0;
+        double fMax = 0;
+        StreamingQuantile quantile;
+    };
+
+    std::vector<Filter> m_filters;
+    std::vector<std::string> m_groupBy;
+    std::vector<size_t> m_groupFields;     ///< Index of each group-by column in the projected row
+    std::vector<AggregateSpec> m_aggregates;
+
+    std::vector<Group> m_groups;
+    std::vector<std::vector<AggregateState>> m_states;    ///< Per group, per aggregate
+    std::unordered_map<std::string, size_t> m_groupIndex; ///< Encoded key -> group
+    size_t m_nRowsScanned = 0;
+    size_t m_nRowsMatched = 0;
+
+    /**
+     * @brief Index of a column in the projection, adding it if new
+     */
+    static size_t addColumn(std::vector<std::string>& columns, const std::string& column);
+
+    bool passesFilters(const std::vector<std::string_view>& fields) const;
+    size_t findGroup(const std::vector<std::string_view>& fields, std::string& key);
+    void accumulate(size_t group, const std::vector<std::string_view>& fields);
+    void finish();
+};
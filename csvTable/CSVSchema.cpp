@@ -0,0 +1,223 @@
+#include "CSVSchema.h"
+#include "utils/csvFile/CSVMappedReader.h"
+#include "utils/csvFile/CSVNumber.h"
+
+#include <chrono>
+#include <unordered_set>
+
+namespace {
+
+constexpr int64_t MICROSECONDS_PER_SECOND = 1000000;
+constexpr int64_t SECONDS_PER_DAY = 86400;
+constexpr int64_t SECONDS_PER_HOUR = 3600;
+constexpr int64_t SECONDS_PER_MINUTE = 60;
+constexpr int FRACTION_DIGITS = 6;         // microsecond resolution; further digits are truncated
+
+bool equalsIgnoreCase(std::string_view text, std::string_view word)
+{
+    if (text.size() != word.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = (char)(c - 'A' + 'a');
+        }
+        if (c != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Read exactly nDigits decimal digits at pos
+ */
+bool readDigits(std::string_view text, size_t& pos, size_t nDigits, int& value)
+{
+    if (pos + nDigits > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < nDigits; ++i) {
+        char c = text[pos + i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    pos += nDigits;
+    return true;
+}
+
+bool readChar(std::string_view text, size_t& pos, char c)
+{
+    if (pos < text.size() && text[pos] == c) {
+        pos++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Votes of the sampled values of one column
+ */
+struct ColumnVotes
+{
+    size_t nValues = 0;
+    bool isBool = true;
+    bool isInt64 = true;
+    bool isDouble = true;
+    bool isTimestamp = true;
+    std::unordered_set<std::string> distinct;
+};
+
+} // namespace
+
+bool CSVSchema::infer(CSVMappedReader& reader, size_t nSampleRows)
+{
+    m_columns.clear();
+    if (!reader.isValid() || reader.getHeaders().empty()) {
+        return false;
+    }
+
+    const std::vector<std::string>& headers = reader.getHeaders();
+    std::vector<ColumnVotes> votes(headers.size());
+    std::vector<std::string_view> fields;
+    for (size_t row = 0; row < nSampleRows && reader.readRow(fields); ++row) {
+        for (size_t i = 0; i < fields.size() && i < votes.size(); ++i) {
+            std::string_view text = CSVNumber::trim(fields[i]);
+            if (text.empty()) {
+                continue;
+            }
+            ColumnVotes& vote = votes[i];
+            vote.nValues++;
+            bool bValue;
+            int64_t intValue;
+            double fValue;
+            vote.isBool = vote.isBool && parseBool(text, bValue);
+            vote.isInt64 = vote.isInt64 && CSVNumber::parse(text, intValue) == CSVNumber::Status::Ok;
+            vote.isDouble = vote.isDouble && CSVNumber::parse(text, fValue) == CSVNumber::Status::Ok;
+            vote.isTimestamp = vote.isTimestamp && parseTimestamp(text, intValue);
+            vote.distinct.emplace(fields[i]);
+        }
+    }
+    reader.reset();
+
+    for (size_t i = 0; i < headers.size(); ++i) {
+        const ColumnVotes& vote = votes[i];
+        Column& column = m_columns.emplace_back();
+        column.name = headers[i];
+        if (vote.nValues == 0) {
+            column.type = Type::String;
+        } else if (vote.isBool) {
+            column.type = Type::Bool;
+        } else if (vote.isInt64) {
+            column.type = Type::Int64;
+        } else if (vote.isDouble) {
+            column.type = Type::Double;
+        } else if (vote.isTimestamp) {
+            column.type = Type::Timestamp;
+        } else {
+            column.type = Type::String;
+        }
+        column.bDictionary = column.type == Type::String && vote.nValues > 0 &&
+            (double)vote.distinct.size() <= DICTIONARY_MAX_DISTINCT_RATIO * (double)vote.nValues;
+    }
+    return true;
+}
+
+bool CSVSchema::setColumnType(const std::string& name, Type type, bool bDictionary)
+{
+    for (Column& column : m_columns) {
+        if (column.name == name) {
+            column.type = type;
+            column.bDictionary = type == Type::String && bDictionary;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* CSVSchema::getTypeName(Type type)
+{
+    switch (type) {
+    case Type::Bool:      return "bool";
+    case Type::Int64:     return "int64";
+    case Type::Double:    return "double";
+    case Type::Timestamp: return "timestamp";
+    case Type::String:    return "string";
+    }
+    return "";
+}
+
+bool CSVSchema::parseBool(std::string_view text, bool& value)
+{
+    text = CSVNumber::trim(text);
+    if (equalsIgnoreCase(text, "true")) {
+        value = true;
+        return true;
+    }
+    if (equalsIgnoreCase(text, "false")) {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool CSVSchema::parseTimestamp(std::string_view text, int64_t& microseconds)
+{
+    text = CSVNumber::trim(text);
+    size_t pos = 0;
+    int year, month, day;
+    int hours = 0, minutes = 0, seconds = 0, fraction = 0;
+
+    // Date: "YYYY-MM-DD" or "YYYYMMDD"
+    if (!readDigits(text, pos, 4, year)) {
+        return false;
+    }
+    bool isCompact = !readChar(text, pos, '-');
+    if (!readDigits(text, pos, 2, month) || (!isCompact && !readChar(text, pos, '-')) ||
+        !readDigits(text, pos, 2, day)) {
+        return false;
+    }
+
+    // Optional time: "[T ]HH:MM:SS[.fff]" or "-HH:MM:SS" after a compact date
+    if (pos < text.size()) {
+        char separator = isCompact ? '-' : (text[pos] == 'T' ? 'T' : ' ');
+        if (!readChar(text, pos, separator) || !readDigits(text, pos, 2, hours) || !readChar(text, pos, ':') ||
+            !readDigits(text, pos, 2, minutes) || !readChar(text, pos, ':') || !readDigits(text, pos, 2, seconds)) {
+            return false;
+        }
+        if (readChar(text, pos, '.')) {
+            int nDigits = 0;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+                if (nDigits < FRACTION_DIGITS) {
+                    fraction = fraction * 10 + (text[pos] - '0');
+                    nDigits++;
+                }
+                pos++;
+            }
+            if (nDigits == 0) {
+                return false;
+            }
+            for (; nDigits < FRACTION_DIGITS; ++nDigits) {
+                fraction *= 10;
+            }
+        }
+        readChar(text, pos, 'Z');
+    }
+    if (pos != text.size() || hours > 23 || minutes > 59 || seconds > 60) {
+        return false;
+    }
+
+    std::chrono::year_month_day date{ std::chrono::year(year), std::chrono::month((unsigned)month),
+                                      std::chrono::day((unsigned)day) };
+    if (!date.ok()) {
+        return false;
+    }
+    int64_t days = std::chrono::sys_days(date).time_since_epoch().count();
+    int64_t totalSeconds = days * SECONDS_PER_DAY + hours * SECONDS_PER_HOUR + minutes * SECONDS_PER_MINUTE + seconds;
+    microseconds = totalSeconds * MICROSECONDS_PER_SECOND + fraction;
+    return true;
+}
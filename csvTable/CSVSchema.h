@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CSVMappedReader;
+
+/**
+ * @class CSVSchema
+ * @brief Per-column value types of a CSV file, inferred from a sample of rows
+ *
+ * Every non-empty sampled value of a column must parse as the type; empty
+ * cells are nulls and don't vote. Types are tried from the narrowest: Bool
+ * ("true"/"false", any case), Int64, Double, Timestamp, and String for
+ * everything else (and for columns with no sampled values). String columns
+ * whose sample repeats values enough are marked for dictionary encoding.
+ *
+ * Timestamps are ISO 8601 dates with an optional time ("2024-05-01",
+ * "2024-05-01 13:45:10.250", 'T' separator and trailing 'Z' allowed) or the
+ * TimeUtils default "20240501-13:45:10". They are taken as UTC and decoded
+ * to microseconds since the Unix epoch.
+ */
+class CSVSchema
+{
+public:
+    enum class Type
+    {
+        Bool,
+        Int64,
+        Double,
+        Timestamp,
+        String
+    };
+
+    struct Column
+    {
+        std::string name;
+        Type type = Type::String;
+        bool bDictionary = false;          ///< String column to store as codes into a dictionary
+    };
+
+    static constexpr size_t DEFAULT_SAMPLE_ROWS = 1000;
+    static constexpr double DICTIONARY_MAX_DISTINCT_RATIO = 0.5; ///< Distinct / non-empty sampled values
+
+    /**
+     * @brief Infer the column types from the first rows of a reader
+     *
+     * The reader is reset to its first data row afterwards.
+     *
+     * @param nSampleRows Number of data rows to look at
+     * @return false if the reader is invalid or has no headers
+     */
+    bool infer(CSVMappedReader& reader, size_t nSampleRows = DEFAULT_SAMPLE_ROWS);
+
+    /**
+     * @brief Override the type of a column (e.g. force String for an id column)
+     * @return false if there is no such column
+     */
+    bool setColumnType(const std::string& name, Type type, bool bDictionary = false);
+
+    const std::vector<Column>& getColumns() const { return m_columns; }
+
+    static const char* getTypeName(Type type);
+
+    /**
+     * @brief Parse "true" or "false" in any case, ignoring surrounding whitespace
+     */
+    static bool parseBool(std::string_view text, bool& value);
+
+    /**
+     * @brief Parse a timestamp (see class comment) to microseconds since the Unix epoch
+     */
+    static bool parseTimestamp(std::string_view text, int64_t& microseconds);
+
+private:
+    std::vector<Column> m_columns;
+};
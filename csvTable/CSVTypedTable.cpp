@@ -0,0 +1,259 @@
+#include "CSVTypedTable.h"
+#include "utils/csvFile/CSVMappedReader.h"
+#include "utils/csvFile/CSVNumber.h"
+
+#include <limits>
+
+std::string_view CSVTypedColumn::getString(size_t row) const
+{
+    if (m_type != CSVSchema::Type::String) {
+        return {};
+    }
+    return m_bDictionary ? std::string_view(m_dictionary[m_codes[row]]) : std::string_view(m_strings[row]);
+}
+
+double CSVTypedColumn::getAsDouble(size_t row) const
+{
+    if (isNull(row)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    switch (m_type) {
+    case CSVSchema::Type::Bool:      return m_bools[row];
+    case CSVSchema::Type::Int64:     return (double)m_int64s[row];
+    case CSVSchema::Type::Double:    return m_doubles[row];
+    case CSVSchema::Type::Timestamp: return (double)m_int64s[row];
+    case CSVSchema::Type::String:    break;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+size_t CSVTypedColumn::getMemoryBytes() const
+{
+    size_t bytes = m_bools.capacity() + m_int64s.capacity() * sizeof(int64_t) +
+        m_doubles.capacity() * sizeof(double) + m_codes.capacity() * sizeof(uint32_t) + m_nulls.capacity() / 8;
+    for (const std::vector<std::string>* pStrings : { &m_strings, &m_dictionary }) {
+        bytes += pStrings->capacity() * sizeof(std::string);
+        for (const std::string& value : *pStrings) {
+            // Short strings live inside the std::string object
+            if (value.capacity() >= sizeof(std::string)) {
+                bytes += value.capacity() + 1;
+            }
+        }
+    }
+    return bytes;
+}
+
+void CSVTypedColumn::reset(const CSVSchema::Column& schemaColumn)
+{
+    *this = CSVTypedColumn();
+    m_name = schemaColumn.name;
+    m_type = schemaColumn.type;
+    m_bDictionary = schemaColumn.type == CSVSchema::Type::String && schemaColumn.bDictionary;
+}
+
+bool CSVTypedColumn::append(std::string_view text)
+{
+    bool isValid = true;
+    if (CSVNumber::trim(text).empty() && m_type != CSVSchema::Type::String) {
+        appendNull();
+        return true;
+    }
+
+    switch (m_type) {
+    case CSVSchema::Type::Bool: {
+        bool value = false;
+        isValid = CSVSchema::parseBool(text, value);
+        m_bools.push_back(value ? 1 : 0);
+        break;
+    }
+    case CSVSchema::Type::Int64: {
+        int64_t value;
+        isValid = CSVNumber::parse(text, value) == CSVNumber::Status::Ok;
+        m_int64s.push_back(value);
+        break;
+    }
+    case CSVSchema::Type::Double: {
+        double value;
+        isValid = CSVNumber::parse(text, value) == CSVNumber::Status::Ok;
+        m_doubles.push_back(isValid ? value : std::numeric_limits<double>::quiet_NaN());
+        break;
+    }
+    case CSVSchema::Type::Timestamp: {
+        int64_t value = 0;
+        isValid = CSVSchema::parseTimestamp(text, value);
+        m_int64s.push_back(isValid ? value : 0);
+        break;
+    }
+    case CSVSchema::Type::String:
+        if (m_bDictionary) {
+            auto it = m_dictionaryIndex.find(std::string(text));
+            if (it == m_dictionaryIndex.end()) {
+                it = m_dictionaryIndex.emplace(std::string(text), (uint32_t)m_dictionary.size()).first;
+                m_dictionary.emplace_back(text);
+            }
+            m_codes.push_back(it->second);
+        } else {
+            m_strings.emplace_back(text);
+        }
+        break;
+    }
+
+    m_nRows++;
+    if (!isValid) {
+        m_nulls.resize(m_nRows, false);
+        m_nulls.back() = true;
+    } else if (!m_nulls.empty()) {
+        m_nulls.push_back(false);
+    }
+    return isValid;
+}
+
+void CSVTypedColumn::appendNull()
+{
+    switch (m_type) {
+    case CSVSchema::Type::Bool:      m_bools.push_back(0); break;
+    case CSVSchema::Type::Int64:     m_int64s.push_back(0); break;
+    case CSVSchema::Type::Double:    m_doubles.push_back(std::numeric_limits<double>::quiet_NaN()); break;
+    case CSVSchema::Type::Timestamp: m_int64s.push_back(0); break;
+    case CSVSchema::Type::String:    break;
+    }
+    m_nRows++;
+    m_nulls.resize(m_nRows, false);
+    m_nulls.back() = true;
+}
+
+void CSVTypedColumn::finishDecoding()
+{
+    m_dictionaryIndex = std::unordered_map<std::string, uint32_t>();
+    m_bools.shrink_to_fit();
+    m_int64s.shrink_to_fit();
+    m_doubles.shrink_to_fit();
+    m_strings.shrink_to_fit();
+    m_codes.shrink_to_fit();
+    m_dictionary.shrink_to_fit();
+    if (!m_nulls.empty()) {
+        m_nulls.resize(m_nRows, false);
+    }
+}
+
+bool CSVTypedTable::read(const std::string& csvPath, char delimiter, char commentChar, size_t nSampleRows)
+{
+    clear();
+    CSVMappedReader reader(csvPath, commentChar);
+    reader.setDelimiter(delimiter);
+    CSVSchema schema;
+    if (!schema.infer(reader, nSampleRows)) {
+        return false;
+    }
+    return read(reader, schema);
+}
+
+bool CSVTypedTable::read(CSVMappedReader& reader, const CSVSchema& schema)
+{
+    clear();
+    const std::vector<CSVSchema::Column>& schemaColumns = schema.getColumns();
+    const std::vector<std::string>& headers = reader.getHeaders();
+    if (!reader.isValid() || headers.size() != schemaColumns.size()) {
+        return false;
+    }
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < headers.size(); ++i) {
+        if (headers[i] != schemaColumns[i].name) {
+            return false;
+        }
+        selected.push_back(i);
+    }
+
+    m_columns.resize(schemaColumns.size());
+    for (size_t i = 0; i < schemaColumns.size(); ++i) {
+        m_columns[i].reset(schemaColumns[i]);
+    }
+
+    std::vector<size_t> mismatched;
+    std::vector<bool> isNumeric;
+    if (!decodeColumns(reader, selected, mismatched, isNumeric)) {
+        clear();
+        return false;
+    }
+
+    // Widen the columns the sample got wrong and decode just those again
+    if (!mismatched.empty()) {
+        for (size_t i = 0; i < mismatched.size(); ++i) {
+            CSVSchema::Column widened = schemaColumns[mismatched[i]];
+            bool isDouble = widened.type == CSVSchema::Type::Int64 && isNumeric[i];
+            widened.type = isDouble ? CSVSchema::Type::Double : CSVSchema::Type::String;
+            widened.bDictionary = false;
+            m_columns[mismatched[i]].reset(widened);
+        }
+        std::vector<size_t> stillMismatched;
+        decodeColumns(reader, mismatched, stillMismatched, isNumeric);
+    }
+
+    for (CSVTypedColumn& column : m_columns) {
+        column.finishDecoding();
+    }
+    return true;
+}
+
+void CSVTypedTable::clear()
+{
+    m_columns.clear();
+    m_nRows = 0;
+}
+
+const CSVTypedColumn* CSVTypedTable::findColumn(const std::string& name) const
+{
+    for (const CSVTypedColumn& column : m_columns) {
+        if (column.getName() == name) {
+            return &column;
+        }
+    }
+    return nullptr;
+}
+
+size_t CSVTypedTable::getMemoryBytes() const
+{
+    size_t bytes = 0;
+    for (const CSVTypedColumn& column : m_columns) {
+        bytes += column.getMemoryBytes();
+    }
+    return bytes;
+}
+
+bool CSVTypedTable::decodeColumns(CSVMappedReader& reader, const std::vector<size_t>& selected,
+                                  std::vector<size_t>& mismatched, std::vector<bool>& isNumeric)
+{
+    mismatched.clear();
+    isNumeric.clear();
+    std::vector<std::string> names;
+    for (size_t column : selected) {
+        names.push_back(m_columns[column].getName());
+    }
+    reader.reset();
+    if (!reader.setProjection(names)) {
+        return false; // header names are not unique
+    }
+
+    std::vector<int> mismatchSlot(selected.size(), -1);
+    std::vector<std::string_view> fields;
+    size_t nRows = 0;
+    while (reader.readProjectedRow(fields)) {
+        for (size_t i = 0; i < selected.size(); ++i) {
+            if (m_columns[selected[i]].append(fields[i])) {
+                continue;
+            }
+            if (mismatchSlot[i] < 0) {
+                mismatchSlot[i] = (int)mismatched.size();
+                mismatched.push_back(selected[i]);
+                isNumeric.push_back(true);
+            }
+            double value;
+            if (CSVNumber::parse(fields[i], value) != CSVNumber::Status::Ok) {
+                isNumeric[mismatchSlot[i]] = false;
+            }
+        }
+        nRows++;
+    }
+    m_nRows = nRows;
+    return true;
+}
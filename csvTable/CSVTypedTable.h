@@ -0,0 +1,136 @@
+#pragma once
+
+#include "CSVSchema.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class CSVTypedColumn
+ * @brief Values of one CSV column stored in the vector of its type
+ *
+ * Bool columns use one byte per value, Int64 and Timestamp columns int64_t
+ * (timestamps in microseconds since the Unix epoch), Double columns double and
+ * String columns either the strings themselves or, when dictionary encoded,
+ * one uint32_t code per value into a table of distinct strings. Empty cells
+ * of non-String columns are nulls: NaN in Double columns, otherwise a zero
+ * value; isNull() is true for them.
+ */
+class CSVTypedColumn
+{
+public:
+    const std::string& getName() const { return m_name; }
+    CSVSchema::Type getType() const { return m_type; }
+    bool isDictionary() const { return m_bDictionary; }
+    size_t getRowCount() const { return m_nRows; }
+
+    bool isNull(size_t row) const { return !m_nulls.empty() && m_nulls[row]; }
+
+    std::span<const uint8_t> getBools() const { return m_bools; }
+    std::span<const int64_t> getInt64s() const { return m_int64s; }     ///< Int64 and Timestamp columns
+    std::span<const double> getDoubles() const { return m_doubles; }
+    std::span<const std::string> getStrings() const { return m_strings; } ///< String columns without dictionary
+    std::span<const uint32_t> getCodes() const { return m_codes; }      ///< Dictionary-encoded String columns
+    std::span<const std::string> getDictionary() const { return m_dictionary; }
+
+    /**
+     * @brief String value of a row of a String column, whatever its encoding
+     */
+    std::string_view getString(size_t row) const;
+
+    /**
+     * @brief Value of a row as double: bools are 0/1, timestamps microseconds, strings and nulls NaN
+     */
+    double getAsDouble(size_t row) const;
+
+    /**
+     * @brief Approximate heap memory held by the values
+     */
+    size_t getMemoryBytes() const;
+
+private:
+    friend class CSVTypedTable;
+
+    std::string m_name;
+    CSVSchema::Type m_type = CSVSchema::Type::String;
+    bool m_bDictionary = false;
+    size_t m_nRows = 0;
+    std::vector<uint8_t> m_bools;
+    std::vector<int64_t> m_int64s;
+    std::vector<double> m_doubles;
+    std::vector<std::string> m_strings;
+    std::vector<uint32_t> m_codes;
+    std::vector<std::string> m_dictionary;
+    std::unordered_map<std::string, uint32_t> m_dictionaryIndex; ///< Only while decoding
+    std::vector<bool> m_nulls;             ///< Empty unless the column has a null
+
+    void reset(const CSVSchema::Column& schemaColumn);
+
+    /**
+     * @brief Append a value
+     * @return false if a non-empty value doesn't parse as the column type (it is stored as null)
+     */
+    bool append(std::string_view text);
+
+    void appendNull();
+    void finishDecoding();
+};
+
+/**
+ * @class CSVTypedTable
+ * @brief A CSV file decoded into typed columns (see CSVSchema, CSVTypedColumn)
+ *
+ * Decoding is one pass over a memory-mapped file. If a value after the
+ * inference sample does not fit its column's type, the column is widened,
+ * Int64 to Double when all such values are numbers and to String otherwise,
+ * and decoded again in a second pass over just those columns.
+ */
+class CSVTypedTable
+{
+public:
+    /**
+     * @brief Infer the schema from the first rows and decode the whole file
+     * @return false if the file can't be read or has no headers
+     */
+    bool read(const std::string& csvPath, char delimiter = ',', char commentChar = '\0',
+              size_t nSampleRows = CSVSchema::DEFAULT_SAMPLE_ROWS);
+
+    /**
+     * @brief Decode all data rows of a reader with a given schema
+     * @return false if the schema doesn't match the reader's headers or they are not unique
+     */
+    bool read(CSVMappedReader& reader, const CSVSchema& schema);
+
+    void clear();
+
+    size_t getRowCount() const { return m_nRows; }
+    size_t getColumnCount() const { return m_columns.size(); }
+    const CSVTypedColumn& getColumn(size_t index) const { return m_columns[index]; }
+
+    /**
+     * @brief Column by name, nullptr if there is none
+     */
+    const CSVTypedColumn* findColumn(const std::string& name) const;
+
+    /**
+     * @brief Approximate heap memory held by all columns
+     */
+    size_t getMemoryBytes() const;
+
+private:
+    std::vector<CSVTypedColumn> m_columns;
+    size_t m_nRows = 0;
+
+    /**
+     * @brief Decode the selected columns of all rows from the reader's first data row
+     * @param mismatched Output, the selected columns that had values not fitting their type
+     * @param isNumeric Output per column, whether all mismatching values were numbers
+     * @return false if the selected header names are not unique
+     */
+    bool decodeColumns(CSVMappedReader& reader, const std::vector<size_t>& selected,
+                       std::vector<size_t>& mismatched, std::vector<bool>& isNumeric);
+};
@@ -0,0 +1,101 @@
+#include "StreamingQuantile.h"
+#include <algorithm>
+#include <limits>
+
+StreamingQuantile::StreamingQuantile(double fQuantile)
+    : m_fQuantile(std::clamp(fQuantile, 0.0, 1.0))
+{
+    double p = m_fQuantile;
+    double increments[MARKERS] = { 0.0, p / 2, p, (1 + p) / 2, 1.0 };
+    double desired[MARKERS] = { 1.0, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5.0 };
+    for (size_t i = 0; i < MARKERS; ++i) {
+        m_increments[i] = increments[i];
+        m_desired[i] = desired[i];
+        m_positions[i] = (double)(i + 1);
+    }
+}
+
+void StreamingQuantile::addSample(double fValue)
+{
+    if (m_nCount < MARKERS) {
+        m_heights[m_nCount++] = fValue;
+        if (m_nCount == MARKERS) {
+            std::sort(m_heights, m_heights + MARKERS);
+        }
+        return;
+    }
+    m_nCount++;
+
+    // Cell k holds the new value; markers above it move up one rank
+    size_t k;
+    if (fValue < m_heights[0]) {
+        m_heights[0] = fValue;
+        k = 0;
+    } else if (fValue >= m_heights[MARKERS - 1]) {
+        m_heights[MARKERS - 1] = fValue;
+        k = MARKERS - 2;
+    } else {
+        k = 0;
+        while (fValue >= m_heights[k + 1]) {
+            k++;
+        }
+    }
+    for (size_t i = k + 1; i < MARKERS; ++i) {
+        m_positions[i] += 1;
+    }
+    for (size_t i = 0; i < MARKERS; ++i) {
+        m_desired[i] += m_increments[i];
+    }
+
+    // Move the inner markers towards their desired positions
+    for (size_t i = 1; i < MARKERS - 1; ++i) {
+        double d = m_desired[i] - m_positions[i];
+        if ((d >= 1 && m_positions[i + 1] - m_positions[i] > 1) ||
+            (d <= -1 && m_positions[i - 1] - m_positions[i] < -1)) {
+            double fDirection = d > 0 ? 1.0 : -1.0;
+            double fHeight = parabolic(i, fDirection);
+            if (m_heights[i - 1] < fHeight && fHeight < m_heights[i + 1]) {
+                m_heights[i] = fHeight;
+            } else {
+                m_heights[i] = linear(i, fDirection);
+            }
+            m_positions[i] += fDirection;
+        }
+    }
+}
+
+double StreamingQuantile::getQuantile() const
+{
+    if (m_nCount == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (m_nCount > MARKERS) {
+        return m_heights[2];
+    }
+
+    // Few samples: exact, interpolating between ranks
+    double sorted[MARKERS];
+    std::copy(m_heights, m_heights + m_nCount, sorted);
+    std::sort(sorted, sorted + m_nCount);
+    double fRank = m_fQuantile * (double)(m_nCount - 1);
+    size_t lower = (size_t)fRank;
+    size_t upper = std::min(lower + 1, m_nCount - 1);
+    double fFraction = fRank - (double)lower;
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * fFraction;
+}
+
+double StreamingQuantile::parabolic(size_t i, double fDirection) const
+{
+    const double* n = m_positions;
+    const double* q = m_heights;
+    double d = fDirection;
+    return q[i] + d / (n[i + 1] - n[i - 1]) *
+        ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+         (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double StreamingQuantile::linear(size_t i, double fDirection) const
+{
+    size_t j = fDirection > 0 ? i + 1 : i - 1;
+    return m_heights[i] + fDirection * (m_heights[j] - m_heights[i]) / (m_positions[j] - m_positions[i]);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @class StreamingQuantile
+ * @brief Constant-memory estimate of one quantile of a stream of values
+ *
+ * P-square algorithm (Jain & Chlamtac): five markers track the minimum, the
+ * maximum, the quantile and the two midpoints between them; marker heights
+ * are adjusted with piecewise-parabolic interpolation as values arrive. The
+ * result is exact for up to MARKERS values and an estimate afterwards.
+ */
+class StreamingQuantile
+{
+public:
+    static constexpr size_t MARKERS = 5;
+
+    /**
+     * @param fQuantile Quantile to track, in [0, 1] (0.5 = median)
+     */
+    explicit StreamingQuantile(double fQuantile = 0.5);
+
+    void addSample(double fValue);
+
+    size_t getCount() const { return m_nCount; }
+
+    /**
+     * @brief Current estimate, NaN if no samples have been added
+     */
+    double getQuantile() const;
+
+private:
+    double m_fQuantile;
+    size_t m_nCount = 0;
+    double m_heights[MARKERS] = {};     // marker heights (the first samples until MARKERS are seen)
+    double m_positions[MARKERS] = {};   // actual marker positions (1-based ranks)
+    double m_desired[MARKERS] = {};     // desired marker positions
+    double m_increments[MARKERS] = {};  // desired position change per sample
+
+    double parabolic(size_t i, double fDirection) const;
+    double linear(size_t i, double fDirection) const;
+};
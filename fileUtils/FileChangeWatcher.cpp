@@ -0,0 +1,120 @@
+#include "FileChangeWatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#ifdef _WIN32
+#include "WindowsCompat.h"
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void sleepPollInterval(uint32_t timeoutMs)
+{
+    uint32_t sleepMs = std::min(timeoutMs, FileChangeWatcher::POLL_INTERVAL_MS);
+    std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+}
+
+}
+
+#ifdef _WIN32
+
+FileChangeWatcher::FileChangeWatcher(const std::string& filename)
+{
+    // Notifications are per folder; any size or write change in it wakes wait()
+    std::filesystem::path folder = std::filesystem::absolute(filename).parent_path();
+    HANDLE hChange = FindFirstChangeNotificationW(folder.c_str(), FALSE,
+                                                  FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    if (hChange != INVALID_HANDLE_VALUE) {
+        m_hChange = hChange;
+    }
+}
+
+FileChangeWatcher::~FileChangeWatcher()
+{
+    if (m_hChange != nullptr) {
+        FindCloseChangeNotification(m_hChange);
+    }
+}
+
+void FileChangeWatcher::wait(uint32_t timeoutMs)
+{
+    if (m_hChange == nullptr) {
+        sleepPollInterval(timeoutMs);
+        return;
+    }
+    if (WaitForSingleObject(m_hChange, timeoutMs) == WAIT_OBJECT_0) {
+        FindNextChangeNotification(m_hChange);
+    }
+}
+
+bool FileChangeWatcher::isNotifying() const
+{
+    return m_hChange != nullptr;
+}
+
+#elif defined(__linux__)
+
+FileChangeWatcher::FileChangeWatcher(const std::string& filename)
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd >= 0 && inotify_add_watch(m_fd, filename.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE) < 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+FileChangeWatcher::~FileChangeWatcher()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void FileChangeWatcher::wait(uint32_t timeoutMs)
+{
+    if (m_fd < 0) {
+        sleepPollInterval(timeoutMs);
+        return;
+    }
+    pollfd pfd = { m_fd, POLLIN, 0 };
+    if (poll(&pfd, 1, (int)timeoutMs) > 0) {
+        // Drain the queued events; the caller re-checks the file itself
+        alignas(inotify_event) char events[4096];
+        while (read(m_fd, events, sizeof(events)) > 0) {
+        }
+    }
+}
+
+bool FileChangeWatcher::isNotifying() const
+{
+    return m_fd >= 0;
+}
+
+#else
+
+FileChangeWatcher::FileChangeWatcher(const std::string&)
+{
+}
+
+FileChangeWatcher::~FileChangeWatcher()
+{
+}
+
+void FileChangeWatcher::wait(uint32_t timeoutMs)
+{
+    sleepPollInterval(timeoutMs);
+}
+
+bool FileChangeWatcher::isNotifying() const
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @class FileChangeWatcher
+ * @brief Blocks until a file may have changed
+ *
+ * Uses inotify on Linux and a change notification on the file's folder on
+ * Windows. If neither is available (or setting it up fails) wait() sleeps
+ * for POLL_INTERVAL_MS instead, so callers simply re-check the file after
+ * every wait(). Spurious wake-ups are possible; missed changes are not,
+ * because the watch is registered at construction.
+ */
+class FileChangeWatcher
+{
+public:
+    static constexpr uint32_t POLL_INTERVAL_MS = 50; ///< Sleep per wait() when polling
+
+    explicit FileChangeWatcher(const std::string& filename);
+    ~FileChangeWatcher();
+
+    FileChangeWatcher(const FileChangeWatcher&) = delete;
+    FileChangeWatcher& operator=(const FileChangeWatcher&) = delete;
+
+    /**
+     * @brief Wait for a change notification or the timeout, whichever comes first
+     */
+    void wait(uint32_t timeoutMs);
+
+    /**
+     * @brief Whether change notifications are used (false = polling)
+     */
+    bool isNotifying() const;
+
+private:
+#ifdef _WIN32
+    void* m_hChange = nullptr;       ///< HANDLE from FindFirstChangeNotification
+#else
+    int m_fd = -1;                   ///< inotify descriptor
+#endif
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+/**
+ * @struct FileStamp
+ * @brief Size and modification time of a file, used to detect stale sidecar files
+ */
+struct FileStamp
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;     ///< last_write_time in file clock ticks
+
+    bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+
+    /**
+     * @brief Read the stamp of a file
+     * @return false if the file does not exist or cannot be queried
+     */
+    static bool read(const std::string& path, FileStamp& stamp)
+    {
+        std::error_code ec;
+        stamp.size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return false;
+        }
+        stamp.mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
+};
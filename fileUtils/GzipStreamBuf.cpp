@@ -0,0 +1,478 @@
+#include "GzipStreamBuf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <zlib.h>
+
+namespace {
+
+const char* const GZIP_EXTENSION = ".gz";
+
+constexpr int GZIP_WINDOW_BITS = 16 + MAX_WBITS;  // inflate: expect a gzip header and trailer
+constexpr int MEMORY_LEVEL = 8;                   // zlib's default
+constexpr uint8_t GZIP_ID1 = 0x1f;
+constexpr uint8_t GZIP_ID2 = 0x8b;
+constexpr uint8_t GZIP_CM_DEFLATE = 8;
+constexpr uint8_t GZIP_FLAG_EXTRA = 0x04;
+constexpr uint8_t GZIP_OS_UNKNOWN = 255;
+constexpr size_t GZIP_FIXED_HEADER = 10;          // ID1 ID2 CM FLG MTIME(4) XFL OS
+constexpr size_t GZIP_TRAILER = 8;                // CRC32 ISIZE
+constexpr char BLOCK_SUBFIELD_ID1 = 'C';
+constexpr char BLOCK_SUBFIELD_ID2 = 'B';
+constexpr size_t BLOCK_SUBFIELD_BYTES = 4;        // member size, little endian
+constexpr size_t BLOCK_EXTRA = 4 + BLOCK_SUBFIELD_BYTES;                     // SI1 SI2 LEN(2) data
+constexpr size_t BLOCK_HEADER = GZIP_FIXED_HEADER + 2 + BLOCK_EXTRA;         // + XLEN(2)
+constexpr size_t INFLATE_INPUT_BYTES = 1 << 24;   // zlib counts in uInt; large inputs are fed in slices
+
+void storeLE16(char* p, uint32_t value)
+{
+    p[0] = (char)(value & 0xff);
+    p[1] = (char)((value >> 8) & 0xff);
+}
+
+void storeLE32(char* p, uint32_t value)
+{
+    storeLE16(p, value & 0xffff);
+    storeLE16(p + 2, value >> 16);
+}
+
+uint32_t loadLE16(const char* p)
+{
+    return (uint32_t)(uint8_t)p[0] | ((uint32_t)(uint8_t)p[1] << 8);
+}
+
+uint32_t loadLE32(const char* p)
+{
+    return loadLE16(p) | (loadLE16(p + 2) << 16);
+}
+
+/**
+ * @brief One member of a block-written file
+ */
+struct Member
+{
+    size_t offset;                         ///< In the compressed file
+    size_t size;                           ///< Compressed size
+    size_t plainOffset;                    ///< In the uncompressed data
+    size_t plainSize;
+};
+
+/**
+ * @brief Find the members of a file written by GzipStreamBuf
+ * @return false if any member lacks the block size subfield
+ */
+bool findMembers(const std::vector<char>& data, std::vector<Member>& members)
+{
+    size_t pos = 0, plainOffset = 0;
+    while (pos < data.size()) {
+        const char* p = data.data() + pos;
+        size_t remaining = data.size() - pos;
+        if (remaining < BLOCK_HEADER + GZIP_TRAILER || (uint8_t)p[0] != GZIP_ID1 || (uint8_t)p[1] != GZIP_ID2 ||
+            ((uint8_t)p[3] & GZIP_FLAG_EXTRA) == 0 || loadLE16(p + GZIP_FIXED_HEADER) != BLOCK_EXTRA ||
+            p[12] != BLOCK_SUBFIELD_ID1 || p[13] != BLOCK_SUBFIELD_ID2 || loadLE16(p + 14) != BLOCK_SUBFIELD_BYTES) {
+            return false;
+        }
+        size_t size = loadLE32(p + 16);
+        if (size < BLOCK_HEADER + GZIP_TRAILER || size > remaining) {
+            return false;
+        }
+        size_t plainSize = loadLE32(p + size - 4);
+        members.push_back({ pos, size, plainOffset, plainSize });
+        pos += size;
+        plainOffset += plainSize;
+    }
+    return !members.empty();
+}
+
+/**
+ * @brief Inflate members [first, last) into their places in contents
+ */
+void inflateMembers(const std::vector<char>* pData, const std::vector<Member>* pMembers, size_t first, size_t last,
+                    char* pContents, std::atomic<bool>* pFailed)
+{
+    z_stream stream = {};
+    if (inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK) {
+        *pFailed = true;
+        return;
+    }
+    for (size_t i = first; i < last && !*pFailed; ++i) {
+        const Member& member = (*pMembers)[i];
+        inflateReset(&stream);
+        stream.next_in = (Bytef*)(pData->data() + member.offset);
+        stream.avail_in = (uInt)member.size;
+        stream.next_out = (Bytef*)(pContents + member.plainOffset);
+        stream.avail_out = (uInt)member.plainSize;
+        if (inflate(&stream, Z_FINISH) != Z_STREAM_END || stream.avail_out != 0) {
+            *pFailed = true;
+        }
+    }
+    inflateEnd(&stream);
+}
+
+bool inflateSequential(const std::vector<char>& data, std::string& contents)
+{
+    z_stream stream = {};
+    if (inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK) {
+        return false;
+    }
+    contents.clear();
+    size_t inPos = 0;
+    bool isOk = true;
+    std::vector<char> chunk(GzipStreamBuf::BUFFER_BYTES);
+    while (isOk) {
+        if (stream.avail_in == 0) {
+            if (inPos == data.size()) {
+                break;
+            }
+            size_t nBytes = std::min(data.size() - inPos, INFLATE_INPUT_BYTES);
+            stream.next_in = (Bytef*)(data.data() + inPos);
+            stream.avail_in = (uInt)nBytes;
+            inPos += nBytes;
+        }
+        stream.next_out = (Bytef*)chunk.data();
+        stream.avail_out = (uInt)chunk.size();
+        int result = inflate(&stream, Z_NO_FLUSH);
+        contents.append(chunk.data(), chunk.size() - stream.avail_out);
+        if (result == Z_STREAM_END) {
+            inflateReset(&stream); // another member may follow
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            isOk = false;
+        }
+    }
+    // Input that ends inside a member is truncated
+    isOk = isOk && stream.total_in == 0;
+    inflateEnd(&stream);
+    return isOk;
+}
+
+}
+
+struct GzipStreamBuf::ZStream
+{
+    z_stream stream = {};
+    bool bDeflate = false;
+
+    ~ZStream()
+    {
+        if (bDeflate) {
+            deflateEnd(&stream);
+        } else {
+            inflateEnd(&stream);
+        }
+    }
+};
+
+GzipStreamBuf::~GzipStreamBuf()
+{
+    close();
+}
+
+bool GzipStreamBuf::isGzipPath(const std::string& filename)
+{
+    size_t length = strlen(GZIP_EXTENSION);
+    return filename.size() > length && filename.compare(filename.size() - length, length, GZIP_EXTENSION) == 0;
+}
+
+std::unique_ptr<std::streambuf> GzipStreamBuf::openFile(const std::string& filename, std::ios::openmode mode)
+{
+    bool bWrite = (mode & std::ios::out) != 0;
+    if (isGzipPath(filename)) {
+        auto pGzip = std::make_unique<GzipStreamBuf>();
+        bool isOpen = bWrite ? pGzip->openWrite(filename) : pGzip->openRead(filename);
+        return isOpen ? std::move(pGzip) : nullptr;
+    }
+    auto pFile = std::make_unique<std::filebuf>();
+    if (pFile->open(filename, bWrite ? std::ios::out | std::ios::trunc : std::ios::in) == nullptr) {
+        return nullptr;
+    }
+    return pFile;
+}
+
+bool GzipStreamBuf::openRead(const std::string& filename)
+{
+    close();
+    m_in.open(filename, std::ios::in | std::ios::binary);
+    if (!m_in.is_open()) {
+        return false;
+    }
+    auto pStream = std::make_unique<ZStream>();
+    if (inflateInit2(&pStream->stream, GZIP_WINDOW_BITS) != Z_OK) {
+        m_in.close();
+        return false;
+    }
+    m_pStream = std::move(pStream);
+    m_bWriting = false;
+    m_compressed.resize(BUFFER_BYTES);
+    m_plain.resize(BUFFER_BYTES);
+    return rewind();
+}
+
+bool GzipStreamBuf::openWrite(const std::string& filename, int level)
+{
+    close();
+    m_out.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open()) {
+        return false;
+    }
+    auto pStream = std::make_unique<ZStream>();
+    if (deflateInit2(&pStream->stream, level, Z_DEFLATED, -MAX_WBITS, MEMORY_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+        m_out.close();
+        return false;
+    }
+    pStream->bDeflate = true;
+    m_plain.resize(BLOCK_BYTES);
+    m_compressed.resize(BLOCK_HEADER + deflateBound(&pStream->stream, BLOCK_BYTES) + GZIP_TRAILER);
+    m_pStream = std::move(pStream);
+    m_bWriting = true;
+    m_bMemberWritten = false;
+    setp(m_plain.data(), m_plain.data() + m_plain.size());
+    return true;
+}
+
+bool GzipStreamBuf::close()
+{
+    if (m_pStream == nullptr) {
+        return true;
+    }
+    bool isOk = !m_bFailed;
+    if (m_bWriting) {
+        // A gzip file needs at least one member, even if it is empty
+        size_t pending = pptr() - pbase();
+        if (pending > 0 || !m_bMemberWritten) {
+            isOk = writeMember(pbase(), pending) && isOk;
+        }
+        m_out.close();
+        isOk = isOk && !m_out.fail();
+        setp(nullptr, nullptr);
+    } else {
+        m_in.close();
+        setg(nullptr, nullptr, nullptr);
+    }
+    m_pStream.reset();
+    m_bFailed = false;
+    return isOk;
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::underflow()
+{
+    if (m_pStream == nullptr || m_bWriting) {
+        return traits_type::eof();
+    }
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    m_plainOffset += egptr() - eback();
+    setg(m_plain.data(), m_plain.data(), m_plain.data());
+    if (!fillPlain()) {
+        if (m_bFailed) {
+            throw std::ios_base::failure("corrupt or truncated gzip data");
+        }
+        return traits_type::eof();
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type c)
+{
+    if (m_pStream == nullptr || !m_bWriting) {
+        return traits_type::eof();
+    }
+    if (pptr() == epptr()) {
+        if (!writeMember(pbase(), pptr() - pbase())) {
+            return traits_type::eof();
+        }
+        setp(m_plain.data(), m_plain.data() + m_plain.size());
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int GzipStreamBuf::sync()
+{
+    if (m_pStream == nullptr || !m_bWriting) {
+        return 0;
+    }
+    size_t pending = pptr() - pbase();
+    if (pending > 0) {
+        if (!writeMember(pbase(), pending)) {
+            return -1;
+        }
+        setp(m_plain.data(), m_plain.data() + m_plain.size());
+    }
+    m_out.flush();
+    return m_out.good() ? 0 : -1;
+}
+
+GzipStreamBuf::pos_type GzipStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (m_pStream == nullptr || m_bWriting || (which & std::ios_base::in) == 0) {
+        return pos_type(off_type(-1));
+    }
+    uint64_t current = m_plainOffset + (gptr() - eback());
+    if (dir == std::ios_base::cur) {
+        return seekpos(pos_type(off_type(current) + off), which);
+    }
+    if (dir == std::ios_base::end) {
+        // The length is only known after inflating everything
+        while (underflow() != traits_type::eof()) {
+            setg(eback(), egptr(), egptr());
+        }
+        return seekpos(pos_type(off_type(m_plainOffset + (egptr() - eback())) + off), which);
+    }
+    return seekpos(pos_type(off), which);
+}
+
+GzipStreamBuf::pos_type GzipStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    off_type target = off_type(pos);
+    if (m_pStream == nullptr || m_bWriting || (which & std::ios_base::in) == 0 || target < 0) {
+        return pos_type(off_type(-1));
+    }
+    if ((uint64_t)target < m_plainOffset && !rewind()) {
+        return pos_type(off_type(-1));
+    }
+    // Inflate and skip until the target is in the get area (or just past its end)
+    while ((uint64_t)target > m_plainOffset + (egptr() - eback())) {
+        setg(eback(), egptr(), egptr());
+        if (underflow() == traits_type::eof()) {
+            return pos_type(off_type(-1));
+        }
+    }
+    setg(eback(), eback() + (size_t)((uint64_t)target - m_plainOffset), egptr());
+    return pos;
+}
+
+bool GzipStreamBuf::fillPlain()
+{
+    z_stream* pStream = &m_pStream->stream;
+    pStream->next_out = (Bytef*)m_plain.data();
+    pStream->avail_out = (uInt)m_plain.size();
+    while (pStream->avail_out == m_plain.size() && !m_bFailed) {
+        if (pStream->avail_in == 0) {
+            if (m_bInputEnd) {
+                break;
+            }
+            m_in.read(m_compressed.data(), (std::streamsize)m_compressed.size());
+            size_t nRead = (size_t)m_in.gcount();
+            if (nRead == 0) {
+                // Ending inside a member (inflateReset zeroes total_in between members) is truncation
+                m_bInputEnd = true;
+                m_bFailed = pStream->total_in != 0;
+                break;
+            }
+            pStream->next_in = (Bytef*)m_compressed.data();
+            pStream->avail_in = (uInt)nRead;
+        }
+        int result = inflate(pStream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            inflateReset(pStream); // another member may follow
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            m_bFailed = true;
+        }
+    }
+    size_t produced = m_plain.size() - pStream->avail_out;
+    setg(m_plain.data(), m_plain.data(), m_plain.data() + produced);
+    return produced > 0;
+}
+
+bool GzipStreamBuf::rewind()
+{
+    z_stream* pStream = &m_pStream->stream;
+    m_in.clear();
+    m_in.seekg(0);
+    inflateReset(pStream);
+    pStream->next_in = nullptr;
+    pStream->avail_in = 0;
+    m_bInputEnd = false;
+    m_bFailed = false;
+    m_plainOffset = 0;
+    setg(m_plain.data(), m_plain.data(), m_plain.data());
+    return m_in.good();
+}
+
+bool GzipStreamBuf::writeMember(const char* pData, size_t size)
+{
+    z_stream* pStream = &m_pStream->stream;
+    char* pMember = m_compressed.data();
+    deflateReset(pStream);
+    pStream->next_in = (Bytef*)pData;
+    pStream->avail_in = (uInt)size;
+    pStream->next_out = (Bytef*)(pMember + BLOCK_HEADER);
+    pStream->avail_out = (uInt)(m_compressed.size() - BLOCK_HEADER - GZIP_TRAILER);
+    if (deflate(pStream, Z_FINISH) != Z_STREAM_END) {
+        m_bFailed = true;
+        return false;
+    }
+    size_t memberSize = BLOCK_HEADER + pStream->total_out + GZIP_TRAILER;
+
+    // Header with the block size subfield, then the deflate data, then CRC32 and ISIZE
+    memset(pMember, 0, BLOCK_HEADER);
+    pMember[0] = (char)GZIP_ID1;
+    pMember[1] = (char)GZIP_ID2;
+    pMember[2] = (char)GZIP_CM_DEFLATE;
+    pMember[3] = (char)GZIP_FLAG_EXTRA;
+    pMember[9] = (char)GZIP_OS_UNKNOWN;
+    storeLE16(pMember + GZIP_FIXED_HEADER, BLOCK_EXTRA);
+    pMember[12] = BLOCK_SUBFIELD_ID1;
+    pMember[13] = BLOCK_SUBFIELD_ID2;
+    storeLE16(pMember + 14, BLOCK_SUBFIELD_BYTES);
+    storeLE32(pMember + 16, (uint32_t)memberSize);
+    char* pTrailer = pMember + memberSize - GZIP_TRAILER;
+    storeLE32(pTrailer, (uint32_t)crc32(0, (const Bytef*)pData, (uInt)size));
+    storeLE32(pTrailer + 4, (uint32_t)size);
+
+    m_out.write(pMember, (std::streamsize)memberSize);
+    m_bMemberWritten = true;
+    if (!m_out.good()) {
+        m_bFailed = true;
+        return false;
+    }
+    return true;
+}
+
+bool GzipStreamBuf::decompressFile(const std::string& filename, std::string& contents, unsigned nThreads)
+{
+    contents.clear();
+    std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::vector<char> data((size_t)in.tellg());
+    in.seekg(0);
+    in.read(data.data(), (std::streamsize)data.size());
+    if (!in.good() && !data.empty()) {
+        return false;
+    }
+
+    std::vector<Member> members;
+    if (!findMembers(data, members)) {
+        return inflateSequential(data, contents);
+    }
+
+    // Block-written file: every member knows where its output goes
+    contents.resize(members.back().plainOffset + members.back().plainSize);
+    size_t nWorkers = nThreads != 0 ? nThreads : std::max(1u, std::thread::hardware_concurrency());
+    nWorkers = std::min(nWorkers, members.size());
+    std::atomic<bool> bFailed = false;
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < nWorkers; ++i) {
+        threads.emplace_back(inflateMembers, &data, &members, members.size() * i / nWorkers,
+                             members.size() * (i + 1) / nWorkers, contents.data(), &bFailed);
+    }
+    inflateMembers(&data, &members, 0, members.size() / nWorkers, contents.data(), &bFailed);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (bFailed) {
+        contents.clear();
+        return false;
+    }
+    return true;
+}
+
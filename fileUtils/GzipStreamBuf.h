@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * @class GzipStreamBuf
+ * @brief Stream buffer that reads or writes a gzip-compressed file
+ *
+ * Reading inflates the file in BUFFER_BYTES chunks as the stream consumes
+ * it; concatenated gzip members are read as one stream. Positions are
+ * offsets into the uncompressed data. Seeking forward inflates and skips,
+ * seeking backward restarts from the beginning of the file. Corrupt data or
+ * a file that ends inside a member makes underflow() throw
+ * std::ios_base::failure, which an istream reports as badbit.
+ *
+ * Writing compresses every BLOCK_BYTES of data into its own gzip member.
+ * The result is a standard gzip file, but its members can be inflated
+ * independently: each member header carries an extra subfield ('C','B')
+ * holding the member's compressed size, which decompressFile() uses to
+ * inflate members in parallel. Flushing the stream (sync()) ends the
+ * current member early and flushes the file, so flushed data survives a
+ * crash; flushing often costs compression ratio.
+ *
+ * zlib comes from the utils/zlib submodule, built by zlibStatic.
+ */
+class GzipStreamBuf : public std::streambuf
+{
+public:
+    static constexpr size_t BUFFER_BYTES = 1 << 16;  ///< Read chunk size, compressed and uncompressed
+    static constexpr size_t BLOCK_BYTES = 1 << 20;   ///< Uncompressed bytes per member when writing
+    static constexpr int DEFAULT_LEVEL = 6;          ///< zlib compression level (1 = fastest, 9 = smallest)
+
+    GzipStreamBuf() = default;
+    ~GzipStreamBuf() override;
+
+    GzipStreamBuf(const GzipStreamBuf&) = delete;
+    GzipStreamBuf& operator=(const GzipStreamBuf&) = delete;
+
+    /**
+     * @brief Open a gzip file for reading
+     */
+    bool openRead(const std::string& filename);
+
+    /**
+     * @brief Create or truncate a file for writing compressed data
+     */
+    bool openWrite(const std::string& filename, int level = DEFAULT_LEVEL);
+
+    /**
+     * @brief Write the last block (when writing) and close the file
+     * @return false if data could not be compressed or written
+     */
+    bool close();
+
+    bool isOpen() const { return m_pStream != nullptr; }
+
+    /**
+     * @brief Whether a path names a gzip file (".gz" extension)
+     */
+    static bool isGzipPath(const std::string& filename);
+
+    /**
+     * @brief Open a file stream buffer, compressed if the path ends in ".gz"
+     * @param mode std::ios::in to read, std::ios::out to create or truncate
+     * @return A GzipStreamBuf or a std::filebuf; nullptr if the file can't be opened
+     */
+    static std::unique_ptr<std::streambuf> openFile(const std::string& filename, std::ios::openmode mode);
+
+    /**
+     * @brief Decompress a whole gzip file into memory
+     *
+     * Files written by GzipStreamBuf are inflated member by member on
+     * nThreads threads; other gzip files are inflated sequentially.
+     *
+     * @param nThreads Number of threads (0 = hardware concurrency)
+     * @return false if the file can't be read or is not valid gzip data
+     */
+    static bool decompressFile(const std::string& filename, std::string& contents, unsigned nThreads = 0);
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type c) override;
+    int sync() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    struct ZStream;                        ///< zlib stream state, defined where zlib is included
+    std::unique_ptr<ZStream> m_pStream;    ///< Inflating or deflating, nullptr when closed
+    bool m_bWriting = false;
+    bool m_bInputEnd = false;              ///< No more compressed bytes in the file
+    bool m_bFailed = false;                ///< Corrupt input or a write error
+    bool m_bMemberWritten = false;         ///< At least one member was written
+    std::ifstream m_in;
+    std::ofstream m_out;
+    std::vector<char> m_compressed;        ///< Compressed bytes read but not inflated yet / deflate output
+    std::vector<char> m_plain;             ///< Get area when reading, put area when writing
+    uint64_t m_plainOffset = 0;            ///< Uncompressed offset of the get area start
+
+    /**
+     * @brief Inflate the next chunk into the get area
+     * @return false at the end of the data
+     */
+    bool fillPlain();
+
+    /**
+     * @brief Restart reading from the beginning of the file
+     */
+    bool rewind();
+
+    /**
+     * @brief Compress data into one gzip member and write it
+     */
+    bool writeMember(const char* pData, size_t size);
+};
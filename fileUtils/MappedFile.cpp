@@ -0,0 +1,121 @@
+#include "MappedFile.h"
+#include "GzipStreamBuf.h"
+
+#ifdef _WIN32
+#include "WindowsCompat.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::openGzip(const std::string& filename)
+{
+    if (!GzipStreamBuf::decompressFile(filename, m_inflated)) {
+        m_inflated.clear();
+        return false;
+    }
+    m_bOpen = true;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+    if (GzipStreamBuf::isGzipPath(filename)) {
+        return openGzip(filename);
+    }
+
+    HANDLE hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        CloseHandle(hFile);
+        return false;
+    }
+    size_t size = (size_t)fileSize.QuadPart;
+    if (size == 0) {
+        CloseHandle(hFile);
+        m_bOpen = true;
+        return true;
+    }
+
+    const char* pData = nullptr;
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (hMapping != nullptr) {
+        pData = (const char*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        // the view keeps the mapping and the file open
+        CloseHandle(hMapping);
+    }
+    CloseHandle(hFile);
+    if (pData == nullptr) {
+        return false;
+    }
+    m_pMapping = std::unique_ptr<const char, Unmapper>(pData, Unmapper{ size });
+    m_bOpen = true;
+    return true;
+}
+
+void MappedFile::Unmapper::operator()(const char* pData) const
+{
+    UnmapViewOfFile(pData);
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+    if (GzipStreamBuf::isGzipPath(filename)) {
+        return openGzip(filename);
+    }
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    if (size > 0) {
+        void* pMapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMapping == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        madvise(pMapping, size, MADV_SEQUENTIAL);
+        m_pMapping = std::unique_ptr<const char, Unmapper>((const char*)pMapping, Unmapper{ size });
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    m_bOpen = true;
+    return true;
+}
+
+void MappedFile::Unmapper::operator()(const char* pData) const
+{
+    munmap((void*)pData, size);
+}
+
+#endif
+
+void MappedFile::close()
+{
+    m_pMapping.reset();
+    std::string().swap(m_inflated);
+    m_bOpen = false;
+}
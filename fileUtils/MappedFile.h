@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Uses CreateFileMapping on Windows and mmap elsewhere. An empty file opens
+ * successfully with size() == 0 and no mapping. The mapping is owned by a
+ * unique_ptr whose deleter unmaps it; the file itself is closed once mapped.
+ *
+ * A ".gz" file can't be mapped usefully; it is decompressed into memory
+ * instead (GzipStreamBuf::decompressFile) and data() points at the result.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map the file, replacing any previous mapping
+     * @return true if the file was opened and mapped
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Unmap and close the file
+     */
+    void close();
+
+    bool isOpen() const { return m_bOpen; }
+    const char* data() const { return m_pMapping ? m_pMapping.get() : m_inflated.data(); }
+    size_t size() const { return m_pMapping ? m_pMapping.get_deleter().size : m_inflated.size(); }
+    std::string_view view() const { return std::string_view(data(), size()); }
+
+private:
+    /**
+     * @brief Deleter that unmaps a view of the file
+     */
+    struct Unmapper
+    {
+        size_t size;                 ///< Mapped length in bytes
+        void operator()(const char* pData) const;
+    };
+
+    std::unique_ptr<const char, Unmapper> m_pMapping{ nullptr, Unmapper{ 0 } }; ///< Mapped file, nullptr when empty or inflated
+    std::string m_inflated;          ///< Decompressed contents of a gzip file
+    bool m_bOpen = false;
+
+    /**
+     * @brief Decompress a gzip file into m_inflated
+     */
+    bool openGzip(const std::string& filename);
+};
@@ -1,8 +1,9 @@
 #include "utils/frameViewAnalyzer/FrameViewAnalyzer.h"
-#include "utils/csvFile/CSVFileReader.h"
+#include "utils/csvTable/CSVColumnCache.h"
 
 #include <algorithm>
 #include <cmath>
+#include <span>
 #include <vector>
 
 static const char* const COLUMN_NAME = "MsBetweenDisplayChange";
@@ -27,84 +28,65 @@ bool FrameViewAnalyzer::analyze(const std::filesystem::path& csvPath,
 {
     outMetrics = FrameViewMetrics{};
 
-    CSVFileReader reader(csvPath.string());
-    if (!reader.isValid()) {
+    // Columns come from the binary sidecar cache when it is up to date, so
+    // re-analyzing the same capture does not parse its text again. Only the
+    // four columns used below are parsed and cached.
+    CSVColumnCache columns;
+    if (!columns.open(csvPath.string(), { COLUMN_NAME, LATENCY_COLUMN_NAME, UNTIL_DISPLAYED_COLUMN_NAME,
+                                          RENDER_PRESENT_COLUMN_NAME })) {
         outError = "Failed to open FrameView CSV: " + csvPath.string();
         return false;
     }
 
-    // Find the MsBetweenDisplayChange and MsPCLatency columns
-    const auto& headers = reader.getHeaders();
-    size_t colIndex = headers.size(); // invalid sentinel
-    size_t latencyColIndex = headers.size();
-    size_t untilDisplayedColIndex = headers.size();
-    size_t renderPresentColIndex = headers.size();
-    for (size_t i = 0; i < headers.size(); ++i) {
-        if (headers[i] == COLUMN_NAME) colIndex = i;
-        else if (headers[i] == LATENCY_COLUMN_NAME) latencyColIndex = i;
-        else if (headers[i] == UNTIL_DISPLAYED_COLUMN_NAME) untilDisplayedColIndex = i;
-        else if (headers[i] == RENDER_PRESENT_COLUMN_NAME) renderPresentColIndex = i;
-    }
-    if (colIndex >= headers.size()) {
+    // Find the MsBetweenDisplayChange column; the latency and present-path
+    // columns are optional (empty spans when absent)
+    const auto& headers = columns.getHeaders();
+    if (std::find(headers.begin(), headers.end(), COLUMN_NAME) == headers.end()) {
         outError = std::string("Column '") + COLUMN_NAME + "' not found in " + csvPath.string();
         return false;
     }
+    std::span<const double> displayChanges = columns.getColumn(COLUMN_NAME);
+    std::span<const double> pcLatencies = columns.getColumn(LATENCY_COLUMN_NAME);
+    std::span<const double> untilDisplayedValues = columns.getColumn(UNTIL_DISPLAYED_COLUMN_NAME);
+    std::span<const double> renderPresentValues = columns.getColumn(RENDER_PRESENT_COLUMN_NAME);
 
-    // Read all rows, skip warmup frames, collect intervals and latencies.
+    // Skip warmup frames, collect intervals and latencies.
     // Each interval keeps its original frame index: invalid samples (missing,
     // unparseable, non-positive, or garbage) leave a gap rather than shifting
     // their neighbors together, so the per-window line fits below see true
-    // frame positions.
+    // frame positions. Missing and unparseable cells are NaN, which fails
+    // every range check below.
     struct Sample { size_t idx; double val; };
     std::vector<Sample> intervals;
     std::vector<double> latencies;
     std::vector<double> timesInQueue;
-    std::vector<std::string> row;
-    size_t rowIndex = 0;
-    size_t frameIdx = 0;
-
-    while (reader.readRow(row)) {
-        if (rowIndex < skipFrames) {
-            ++rowIndex;
-            continue;
-        }
-        ++rowIndex;
-        const size_t idx = frameIdx++;
-
-        if (colIndex < row.size() && !row[colIndex].empty()) {
-            try {
-                double val = std::stod(row[colIndex]);
-                if (val > 0.0) {
-                    intervals.push_back({idx, val});
-                }
-            } catch (...) {
-                // Skip unparseable values
-            }
+
+    for (size_t rowIndex = skipFrames; rowIndex < columns.getRowCount(); ++rowIndex) {
+        const size_t idx = rowIndex - skipFrames;
+
+        double val = displayChanges[rowIndex];
+        if (val > 0.0) {
+            intervals.push_back({idx, val});
         }
 
-        if (latencyColIndex < row.size() && !row[latencyColIndex].empty()) {
-            try {
-                double val = std::stod(row[latencyColIndex]);
-                if (val > 0.0 && val <= GARBAGE_CEILING_MS) {
-                    latencies.push_back(val);
-                }
-            } catch (...) {}
+        if (!pcLatencies.empty()) {
+            val = pcLatencies[rowIndex];
+            if (val > 0.0 && val <= GARBAGE_CEILING_MS) {
+                latencies.push_back(val);
+            }
         }
 
         // Time-in-queue is the per-frame difference of two present-path columns.
-        // Only count a frame where both parse to positive values, so a missing
+        // Only count a frame where both are positive values, so a missing
         // half never skews the mean, and reject the row if either exceeds the
         // garbage ceiling (see GARBAGE_CEILING_MS above).
-        if (untilDisplayedColIndex < row.size() && renderPresentColIndex < row.size() &&
-            !row[untilDisplayedColIndex].empty() && !row[renderPresentColIndex].empty()) {
-            try {
-                double untilDisplayed = std::stod(row[untilDisplayedColIndex]);
-                double renderPresent = std::stod(row[renderPresentColIndex]);
-                if (untilDisplayed > 0.0 && renderPresent > 0.0 &&
-                    untilDisplayed <= GARBAGE_CEILING_MS && renderPresent <= GARBAGE_CEILING_MS) {
-                    timesInQueue.push_back(untilDisplayed - renderPresent);
-                }
-            } catch (...) {}
+        if (!untilDisplayedValues.empty() && !renderPresentValues.empty()) {
+            double untilDisplayed = untilDisplayedValues[rowIndex];
+            double renderPresent = renderPresentValues[rowIndex];
+            if (untilDisplayed > 0.0 && renderPresent > 0.0 &&
+                untilDisplayed <= GARBAGE_CEILING_MS && renderPresent <= GARBAGE_CEILING_MS) {
+                timesInQueue.push_back(untilDisplayed - renderPresent);
+            }
         }
     }
 
@@ -0,0 +1,226 @@
+#include "AliasTable.h"
+#include "RNG.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// Uniform values drawn per batch in sample(pOut, nSamples)
+static const size_t SAMPLE_BATCH = 512;
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+{
+    build(weights);
+}
+
+bool AliasTable::build(const std::vector<double>& weights)
+{
+    m_weights.clear();
+    m_blockWeights.clear();
+    m_fTotalWeight = 0;
+    m_bTopDirty = false;
+    if (weights.empty() || weights.size() > UINT32_MAX)
+    {
+        return false;
+    }
+    for (double fWeight : weights)
+    {
+        if (!(fWeight >= 0) || !std::isfinite(fWeight))
+        {
+            return false;
+        }
+    }
+
+    size_t nBlocks = (weights.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    m_weights = weights;
+    m_prob.resize(weights.size());
+    m_alias.resize(weights.size());
+    m_blockWeights.resize(nBlocks);
+    m_blockProb.resize(nBlocks);
+    m_blockAlias.resize(nBlocks);
+    m_dirtyBlocks.assign(nBlocks, 1);
+    m_bTopDirty = true;
+    if (!update())
+    {
+        m_weights.clear();
+        m_blockWeights.clear();
+        m_bTopDirty = false;
+        return false;
+    }
+    return true;
+}
+
+void AliasTable::setWeight(size_t uIndex, double fWeight)
+{
+    assert(uIndex < m_weights.size());
+    assert(fWeight >= 0 && std::isfinite(fWeight));
+    m_weights[uIndex] = fWeight;
+    m_dirtyBlocks[uIndex / BLOCK_SIZE] = 1;
+    m_bTopDirty = true;
+}
+
+bool AliasTable::update()
+{
+    if (!m_bTopDirty)
+    {
+        return true;
+    }
+    // check the new total first so that a rejected update leaves every table untouched
+    double fTotal = 0;
+    for (size_t uBlock = 0; uBlock < getBlockCount(); ++uBlock)
+    {
+        fTotal += m_dirtyBlocks[uBlock] ? getBlockSum(uBlock) : m_blockWeights[uBlock];
+    }
+    if (fTotal <= 0)
+    {
+        return false;
+    }
+    for (size_t uBlock = 0; uBlock < getBlockCount(); ++uBlock)
+    {
+        if (m_dirtyBlocks[uBlock])
+        {
+            buildBlock(uBlock);
+            m_dirtyBlocks[uBlock] = 0;
+        }
+    }
+    m_bTopDirty = false;
+    return buildTop();
+}
+
+size_t AliasTable::sample() const
+{
+    double u[2];
+    RNG::uniform01d(u, 2);
+    return sample(u[0], u[1]);
+}
+
+size_t AliasTable::sample(double fU0, double fU1) const
+{
+    assert(!m_bTopDirty && !m_weights.empty());
+
+    // pick the block
+    double fX = fU0 * getBlockCount();
+    size_t uBlock = std::min((size_t)fX, getBlockCount() - 1);
+    if (fX - uBlock >= m_blockProb[uBlock])
+    {
+        uBlock = m_blockAlias[uBlock];
+    }
+
+    // pick the outcome inside the block
+    size_t uFirst = uBlock * BLOCK_SIZE;
+    size_t nInBlock = std::min(BLOCK_SIZE, m_weights.size() - uFirst);
+    fX = fU1 * nInBlock;
+    size_t uLocal = std::min((size_t)fX, nInBlock - 1);
+    if (fX - uLocal >= m_prob[uFirst + uLocal])
+    {
+        uLocal = m_alias[uFirst + uLocal];
+    }
+    return uFirst + uLocal;
+}
+
+void AliasTable::sample(size_t* pOut, size_t nSamples) const
+{
+    double u[2 * SAMPLE_BATCH];
+    while (nSamples > 0)
+    {
+        size_t nBatch = std::min(nSamples, SAMPLE_BATCH);
+        RNG::uniform01d(u, 2 * nBatch);
+        for (size_t i = 0; i < nBatch; ++i)
+        {
+            pOut[i] = sample(u[2 * i], u[2 * i + 1]);
+        }
+        pOut += nBatch;
+        nSamples -= nBatch;
+    }
+}
+
+double AliasTable::getProbability(size_t uIndex) const
+{
+    assert(uIndex < m_weights.size());
+    size_t uBlock = uIndex / BLOCK_SIZE;
+    if (m_fTotalWeight <= 0 || m_blockWeights[uBlock] <= 0)
+    {
+        return 0;
+    }
+    return (m_blockWeights[uBlock] / m_fTotalWeight) * (m_weights[uIndex] / m_blockWeights[uBlock]);
+}
+
+double AliasTable::getBlockSum(size_t uBlock) const
+{
+    size_t uFirst = uBlock * BLOCK_SIZE;
+    size_t nInBlock = std::min(BLOCK_SIZE, m_weights.size() - uFirst);
+    double fBlockWeight = 0;
+    for (size_t i = 0; i < nInBlock; ++i)
+    {
+        fBlockWeight += m_weights[uFirst + i];
+    }
+    return fBlockWeight;
+}
+
+void AliasTable::buildBlock(size_t uBlock)
+{
+    size_t uFirst = uBlock * BLOCK_SIZE;
+    size_t nInBlock = std::min(BLOCK_SIZE, m_weights.size() - uFirst);
+    double fBlockWeight = getBlockSum(uBlock);
+    m_blockWeights[uBlock] = fBlockWeight;
+    // a block of zero weight is never picked by the top level
+    if (fBlockWeight > 0)
+    {
+        buildAlias(&m_weights[uFirst], nInBlock, fBlockWeight, &m_prob[uFirst], &m_alias[uFirst]);
+    }
+}
+
+bool AliasTable::buildTop()
+{
+    double fTotal = 0;
+    for (double fBlockWeight : m_blockWeights)
+    {
+        fTotal += fBlockWeight;
+    }
+    if (fTotal <= 0)
+    {
+        return false;
+    }
+    m_fTotalWeight = fTotal;
+    buildAlias(m_blockWeights.data(), getBlockCount(), fTotal, m_blockProb.data(), m_blockAlias.data());
+    return true;
+}
+
+//  M. D. Vose, "A linear algorithm for generating random numbers with a given
+//  distribution", IEEE Trans. Software Eng. 17(9), 972-975, 1991.
+void AliasTable::buildAlias(const double* pWeights, size_t n, double fTotal, double* pProb, uint32_t* pAlias)
+{
+    m_scaled.resize(n);
+    m_small.clear();
+    m_large.clear();
+    double fScale = n / fTotal;
+    for (size_t i = 0; i < n; ++i)
+    {
+        m_scaled[i] = pWeights[i] * fScale;
+        (m_scaled[i] < 1 ? m_small : m_large).push_back((uint32_t)i);
+    }
+
+    while (!m_small.empty() && !m_large.empty())
+    {
+        uint32_t uLess = m_small.back();
+        m_small.pop_back();
+        uint32_t uMore = m_large.back();
+        m_large.pop_back();
+
+        pProb[uLess] = m_scaled[uLess];
+        pAlias[uLess] = uMore;
+        m_scaled[uMore] = (m_scaled[uMore] + m_scaled[uLess]) - 1;
+        (m_scaled[uMore] < 1 ? m_small : m_large).push_back(uMore);
+    }
+
+    // leftovers are 1 up to rounding error
+    for (uint32_t i : m_large)
+    {
+        pProb[i] = 1;
+        pAlias[i] = i;
+    }
+    for (uint32_t i : m_small)
+    {
+        pProb[i] = 1;
+        pAlias[i] = i;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Sampler for discrete distributions using Vose's alias method.
+ * 
+ * Outcomes are grouped into blocks of BLOCK_SIZE: a top-level alias table
+ * picks a block by its total weight, and the block's own alias table picks
+ * the outcome. Both lookups are O(1), construction is O(n), and changing a
+ * weight only rebuilds its block and the top level on the next update().
+ * 
+ * Usage:
+ *   AliasTable table(weights);           // weights[i] >= 0, not all zero
+ *   size_t i = table.sample();           // P(i) = weights[i] / sum(weights)
+ *   table.sample(indices.data(), 1000);  // batch draw
+ *   table.setWeight(42, 3.0);            // change weights...
+ *   table.update();                      // ...and rebuild only what changed
+ * 
+ * Sampling is const and may run concurrently from several threads; setWeight()
+ * and update() must not overlap with sampling.
+ */
+class AliasTable
+{
+public:
+    static const size_t BLOCK_SIZE = 256;
+
+    AliasTable() = default;
+    explicit AliasTable(const std::vector<double>& weights);
+
+    /**
+     * Build the table from scratch.
+     * 
+     * @return false if weights are empty, any weight is negative or not finite,
+     *         or all weights are zero (the table is left empty)
+     */
+    bool build(const std::vector<double>& weights);
+
+    /**
+     * Change the weight of one outcome. Takes effect after update().
+     */
+    void setWeight(size_t uIndex, double fWeight);
+
+    /**
+     * Rebuild blocks whose weights changed since the last build/update.
+     * 
+     * @return false if all weights are now zero; nothing is rebuilt and the
+     *         table stays dirty, so sampling and getProbability() need a later
+     *         successful update()
+     */
+    bool update();
+
+    /**
+     * Check if setWeight() was called without a following update().
+     */
+    bool isDirty() const { return m_bTopDirty; }
+
+    /**
+     * Draw an outcome index using the thread-local RNG.
+     */
+    size_t sample() const;
+
+    /**
+     * Draw an outcome index from two uniform values in [0, 1), e.g. from a
+     * quasi-random sequence.
+     */
+    size_t sample(double fU0, double fU1) const;
+
+    /**
+     * Draw nSamples outcome indices using the thread-local RNG.
+     */
+    void sample(size_t* pOut, size_t nSamples) const;
+
+    size_t getSize() const { return m_weights.size(); }
+    double getWeight(size_t uIndex) const { return m_weights[uIndex]; }
+    double getTotalWeight() const { return m_fTotalWeight; }
+
+    /**
+     * Probability of the outcome as represented by the current table.
+     */
+    double getProbability(size_t uIndex) const;
+
+private:
+    // Vose's alias construction for n weights summing to fTotal
+    void buildAlias(const double* pWeights, size_t n, double fTotal, double* pProb, uint32_t* pAlias);
+    double getBlockSum(size_t uBlock) const;
+    void buildBlock(size_t uBlock);
+    bool buildTop();
+
+    size_t getBlockCount() const { return m_blockWeights.size(); }
+
+    std::vector<double> m_weights;
+    double m_fTotalWeight = 0;
+
+    // Per-outcome tables, alias indices are local to the block
+    std::vector<double> m_prob;
+    std::vector<uint32_t> m_alias;
+
+    // Top-level table over blocks
+    std::vector<double> m_blockWeights;
+    std::vector<double> m_blockProb;
+    std::vector<uint32_t> m_blockAlias;
+
+    std::vector<uint8_t> m_dirtyBlocks;
+    bool m_bTopDirty = false;
+
+    // Scratch space of buildAlias(), kept to avoid allocations on update()
+    std::vector<double> m_scaled;
+    std::vector<uint32_t> m_small;
+    std::vector<uint32_t> m_large;
+};
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include "BitMix.h"
+
+/**
+ * Lightweight low-discrepancy point sets for low dimensions.
+ * 
+ * All generators are constexpr, allocation-free and stateless between calls:
+ * any point can be computed directly from its index, so they are cheap to
+ * create per job and safe to share between threads. For high dimensions or
+ * long sequences prefer RNGSobol.
+ * 
+ * Usage:
+ *   HaltonSequence halton(1234);            // Owen-scrambled with seed 1234
+ *   double x = halton.sample(i, 0);         // i-th point, dimension 0
+ * 
+ *   RdSequence r2(2);                       // R2 sequence
+ *   double xy[2]; r2.samplePoint(i, xy);
+ * 
+ *   Rank1Lattice fib = Rank1Lattice::fibonacci(20); // 6765 points in 2D
+ *   double u = fib.sample(i, 1);
+ */
+
+static constexpr unsigned LOW_DISCREPANCY_MAX_DIMS = 32;
+
+// Largest double below 1: results of digit sums are clamped to [0, 1)
+static constexpr double LOW_DISCREPANCY_ONE_MINUS_EPSILON = 0x1.fffffffffffffp-1;
+
+/**
+ * Halton sequence: dimension k is the radical inverse of the index in the k-th prime base.
+ * Optional Owen scrambling permutes every digit depending on the digits before it,
+ * which removes the correlation between higher dimensions of the plain sequence.
+ */
+class HaltonSequence
+{
+public:
+    constexpr HaltonSequence() = default;
+    constexpr explicit HaltonSequence(uint64_t uScrambleSeed)
+        : m_uScrambleSeed(uScrambleSeed), m_bScrambled(true)
+    {
+    }
+
+    /// value in [0, 1) of dimension uDim (< LOW_DISCREPANCY_MAX_DIMS) of point uIndex
+    constexpr double sample(uint64_t uIndex, unsigned uDim) const
+    {
+        assert(uDim < LOW_DISCREPANCY_MAX_DIMS);
+        return m_bScrambled ? scrambledRadicalInverse(uIndex, PRIMES[uDim], mix64(m_uScrambleSeed + uDim))
+                            : radicalInverse(uIndex, PRIMES[uDim]);
+    }
+    constexpr void samplePoint(uint64_t uIndex, unsigned nDims, double* pOut) const
+    {
+        for (unsigned uDim = 0; uDim < nDims; ++uDim)
+        {
+            pOut[uDim] = sample(uIndex, uDim);
+        }
+    }
+
+private:
+    static constexpr uint32_t PRIMES[LOW_DISCREPANCY_MAX_DIMS] =
+    {
+        2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+        59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131
+    };
+
+    static constexpr double radicalInverse(uint64_t uIndex, uint32_t uBase)
+    {
+        // accumulate reversed digits as an integer to avoid rounding in every step
+        double fInvBase = 1.0 / uBase, fInvBaseN = 1.0;
+        uint64_t uReversed = 0;
+        while (uIndex != 0)
+        {
+            uint64_t uNext = uIndex / uBase;
+            uReversed = uReversed * uBase + (uIndex - uNext * uBase);
+            fInvBaseN *= fInvBase;
+            uIndex = uNext;
+        }
+        double fValue = uReversed * fInvBaseN;
+        return fValue < LOW_DISCREPANCY_ONE_MINUS_EPSILON ? fValue : LOW_DISCREPANCY_ONE_MINUS_EPSILON;
+    }
+
+    // Owen scrambling by a random digit shift seeded with a hash of the preceding digits.
+    // Digits past the last non-zero index digit are scrambled too, down to double precision.
+    static constexpr double scrambledRadicalInverse(uint64_t uIndex, uint32_t uBase, uint64_t uSeed)
+    {
+        double fInvBase = 1.0 / uBase, fWeight = fInvBase, fValue = 0;
+        uint64_t uPrefix = uSeed;
+        while (fWeight * uBase > 0x1p-53)
+        {
+            uint64_t uNext = uIndex / uBase;
+            uint64_t uDigit = uIndex - uNext * uBase;
+            uint64_t uShift = mix64(uPrefix) % uBase;
+            fValue += ((uDigit + uShift) % uBase) * fWeight;
+            uPrefix = mix64(uPrefix ^ (uDigit + 1));
+            fWeight *= fInvBase;
+            uIndex = uNext;
+        }
+        return fValue < LOW_DISCREPANCY_ONE_MINUS_EPSILON ? fValue : LOW_DISCREPANCY_ONE_MINUS_EPSILON;
+    }
+
+    uint64_t m_uScrambleSeed = 0;
+    bool m_bScrambled = false;
+};
+
+/**
+ * Additive recurrence R_d (Roberts 2018): x_n = frac(offset + n * alpha), where
+ * alpha_k = 1 / phi_d^(k+1) and phi_d is the positive root of x^(d+1) = x + 1.
+ * For d = 1 this is the golden ratio sequence, d = 2 gives the R2 sequence.
+ * Arithmetic is done in 64-bit fixed point, so the sequence doesn't lose
+ * precision for large indices.
+ */
+class RdSequence
+{
+public:
+    constexpr explicit RdSequence(unsigned nDims, double fOffset = 0.5)
+        : m_nDims(nDims)
+    {
+        assert(nDims > 0 && nDims <= LOW_DISCREPANCY_MAX_DIMS);
+        double fPhi = generalizedGoldenRatio(nDims);
+        double fAlpha = 1.0;
+        uint64_t uOffset = toFixedPoint(fOffset - (uint64_t)fOffset);
+        for (unsigned uDim = 0; uDim < nDims; ++uDim)
+        {
+            fAlpha /= fPhi;
+            m_alpha[uDim] = toFixedPoint(fAlpha);
+            m_offset[uDim] = uOffset;
+        }
+    }
+
+    constexpr unsigned getNDims() const
+    {
+        return m_nDims;
+    }
+    /// apply a per-dimension random shift (Cranley-Patterson rotation), values in [0, 1)
+    constexpr void setOffsets(const double* pOffsets)
+    {
+        for (unsigned uDim = 0; uDim < m_nDims; ++uDim)
+        {
+            m_offset[uDim] = toFixedPoint(pOffsets[uDim]);
+        }
+    }
+    constexpr double sample(uint64_t uIndex, unsigned uDim) const
+    {
+        assert(uDim < m_nDims);
+        // unsigned overflow is the "frac" of the recurrence
+        uint64_t uValue = m_offset[uDim] + uIndex * m_alpha[uDim];
+        return (uValue >> 11) * 0x1p-53;
+    }
+    constexpr void samplePoint(uint64_t uIndex, double* pOut) const
+    {
+        for (unsigned uDim = 0; uDim < m_nDims; ++uDim)
+        {
+            pOut[uDim] = sample(uIndex, uDim);
+        }
+    }
+
+private:
+    static constexpr uint64_t toFixedPoint(double fValue)
+    {
+        return (uint64_t)(fValue * 0x1p53) << 11;
+    }
+    // Newton iteration for x^(d+1) - x - 1 = 0, starting right of the root
+    static constexpr double generalizedGoldenRatio(unsigned nDims)
+    {
+        double x = 2.0;
+        for (int iIteration = 0; iIteration < 64; ++iIteration)
+        {
+            double fPow = 1.0;
+            for (unsigned k = 0; k < nDims; ++k)
+            {
+                fPow *= x;
+            }
+            x -= (fPow * x - x - 1.0) / ((nDims + 1) * fPow - 1.0);
+        }
+        return x;
+    }
+
+    uint64_t m_alpha[LOW_DISCREPANCY_MAX_DIMS] = {};
+    uint64_t m_offset[LOW_DISCREPANCY_MAX_DIMS] = {};
+    unsigned m_nDims = 0;
+};
+
+/**
+ * Rank-1 lattice rule: point i of N is frac(i * z / N + shift) for a generating
+ * vector z. Use all N points together - the set is only equidistributed as a whole.
+ */
+class Rank1Lattice
+{
+public:
+    constexpr Rank1Lattice(uint32_t nPoints, const uint32_t* pGenerator, unsigned nDims)
+        : m_nPoints(nPoints), m_nDims(nDims)
+    {
+        assert(nPoints > 0 && nDims > 0 && nDims <= LOW_DISCREPANCY_MAX_DIMS);
+        for (unsigned uDim = 0; uDim < nDims; ++uDim)
+        {
+            m_generator[uDim] = pGenerator[uDim] % nPoints;
+        }
+    }
+
+    /// 2D Fibonacci lattice: N = F_k, z = (1, F_(k-1)) - optimal in two dimensions
+    static constexpr Rank1Lattice fibonacci(unsigned k)
+    {
+        assert(k >= 2 && k <= 47); // F_47 is the largest Fibonacci number below 2^32
+        uint32_t uPrev = 1, uCur = 1;
+        for (unsigned i = 2; i < k; ++i)
+        {
+            uint32_t uNext = uPrev + uCur;
+            uPrev = uCur;
+            uCur = uNext;
+        }
+        uint32_t generator[2] = { 1, uPrev };
+        return Rank1Lattice(uCur, generator, 2);
+    }
+    /// Korobov lattice: z = (1, a, a^2, ..., a^(d-1)) mod N
+    static constexpr Rank1Lattice korobov(uint32_t nPoints, uint32_t uA, unsigned nDims)
+    {
+        assert(nDims <= LOW_DISCREPANCY_MAX_DIMS);
+        uint32_t generator[LOW_DISCREPANCY_MAX_DIMS] = {};
+        uint64_t uPower = 1;
+        for (unsigned uDim = 0; uDim < nDims; ++uDim)
+        {
+            generator[uDim] = (uint32_t)uPower;
+            uPower = uPower * uA % nPoints;
+        }
+        return Rank1Lattice(nPoints, generator, nDims);
+    }
+
+    constexpr uint32_t getNPoints() const
+    {
+        return m_nPoints;
+    }
+    constexpr unsigned getNDims() const
+    {
+        return m_nDims;
+    }
+    /// apply a per-dimension random shift (Cranley-Patterson rotation), values in [0, 1)
+    constexpr void setShift(const double* pShift)
+    {
+        for (unsigned uDim = 0; uDim < m_nDims; ++uDim)
+        {
+            m_shift[uDim] = pShift[uDim];
+        }
+    }
+    constexpr double sample(uint32_t uIndex, unsigned uDim) const
+    {
+        assert(uIndex < m_nPoints && uDim < m_nDims);
+        uint64_t uNumerator = (uint64_t)uIndex * m_generator[uDim] % m_nPoints;
+        double fValue = (double)uNumerator / m_nPoints + m_shift[uDim];
+        if (fValue >= 1.0)
+        {
+            fValue -= 1.0;
+        }
+        return fValue < LOW_DISCREPANCY_ONE_MINUS_EPSILON ? fValue : LOW_DISCREPANCY_ONE_MINUS_EPSILON;
+    }
+    constexpr void samplePoint(uint32_t uIndex, double* pOut) const
+    {
+        for (unsigned uDim = 0; uDim < m_nDims; ++uDim)
+        {
+            pOut[uDim] = sample(uIndex, uDim);
+        }
+    }
+
+private:
+    uint32_t m_generator[LOW_DISCREPANCY_MAX_DIMS] = {};
+    double m_shift[LOW_DISCREPANCY_MAX_DIMS] = {};
+    uint32_t m_nPoints = 0;
+    unsigned m_nDims = 0;
+};
@@ -1,5 +1,67 @@
 #include "RNG.h"
+#include "utils/serialization/BinarySerializer.h"
 #include <cmath>
+#include <sstream>
+
+namespace {
+
+// Ziggurat parameters for 128 layers: right edge of the base layer and the
+// common area of each layer (Marsaglia & Tsang 2000)
+constexpr int ZIGGURAT_LAYERS = 128;
+constexpr double ZIGGURAT_R = 3.442619855899;
+constexpr double ZIGGURAT_V = 9.91256303526217e-3;
+
+// Binary state format: magic sentinel, then version
+constexpr uint32_t STATE_MAGIC = 0x53474E52; // "RNGS"
+constexpr uint32_t STATE_VERSION = 1;
+
+// 2^-53: maps the top 53 bits of a 64-bit draw to [0, 1)
+constexpr double UNIT_53 = 1.0 / 9007199254740992.0;
+// 2^-24: maps the top 24 bits of a 64-bit draw to [0, 1)
+constexpr float UNIT_24 = 1.0f / 16777216.0f;
+
+struct ZigguratTables
+{
+    double x[ZIGGURAT_LAYERS + 1];     // layer right edges
+    double ratio[ZIGGURAT_LAYERS];     // x[i + 1] / x[i]: fast acceptance threshold
+
+    ZigguratTables()
+    {
+        double f = std::exp(-0.5 * ZIGGURAT_R * ZIGGURAT_R);
+        x[0] = ZIGGURAT_V / f;
+        x[1] = ZIGGURAT_R;
+        x[ZIGGURAT_LAYERS] = 0.0;
+        for (int i = 2; i < ZIGGURAT_LAYERS; ++i)
+        {
+            x[i] = std::sqrt(-2.0 * std::log(ZIGGURAT_V / x[i - 1] + f));
+            f = std::exp(-0.5 * x[i] * x[i]);
+        }
+        for (int i = 0; i < ZIGGURAT_LAYERS; ++i)
+        {
+            ratio[i] = x[i + 1] / x[i];
+        }
+    }
+};
+
+const ZigguratTables& getZigguratTables()
+{
+    static const ZigguratTables s_tables;
+    return s_tables;
+}
+
+// Uniform double in (0, 1) - never returns 0, safe for log()
+inline double openUnit01(std::mt19937_64& generator)
+{
+    return ((generator() >> 11) + 0.5) * UNIT_53;
+}
+
+// Uniform float in [-1, 1)
+inline float signedUnit(std::mt19937_64& generator)
+{
+    return (generator() >> 40) * (2.0f * UNIT_24) - 1.0f;
+}
+
+} // namespace
 
 // Static member definitions
 thread_local std::mt19937_64 RNG::s_generator;
@@ -15,6 +77,51 @@ void RNG::seed(uint64_t seed)
     s_seeded = false;
 }
 
+bool RNG::serializeState(serialization::BinarySerializer& serializer)
+{
+    if (serializer.isWriting())
+    {
+        ensureSeeded();
+    }
+    if (!serializer.serializeSentinel(STATE_MAGIC))
+    {
+        return false;
+    }
+    uint32_t uVersion = STATE_VERSION;
+    serializer.serialize(uVersion);
+    if (!serializer.good() || uVersion != STATE_VERSION)
+    {
+        return false;
+    }
+
+    // std::mt19937_64 only exposes its state through the (portable) text representation
+    std::string sEngineState;
+    if (serializer.isWriting())
+    {
+        std::ostringstream out;
+        out << s_generator;
+        sEngineState = out.str();
+    }
+    serializer.serialize(sEngineState);
+    if (!serializer.good())
+    {
+        return false;
+    }
+    if (serializer.isReading())
+    {
+        std::mt19937_64 generator;
+        std::istringstream in(sEngineState);
+        in >> generator;
+        if (in.fail())
+        {
+            return false;
+        }
+        s_generator = generator;
+        s_seeded = true;
+    }
+    return true;
+}
+
 void RNG::ensureSeeded()
 {
     if (!s_seeded)
@@ -48,6 +155,16 @@ double RNG::uniform01d()
     return dist(s_generator);
 }
 
+void RNG::uniform01d(double* pOut, size_t nValues)
+{
+    ensureSeeded();
+    std::mt19937_64& generator = s_generator;
+    for (size_t i = 0; i < nValues; ++i)
+    {
+        pOut[i] = (generator() >> 11) * UNIT_53;
+    }
+}
+
 float RNG::uniformFloat(float min, float max)
 {
     ensureSeeded();
@@ -72,18 +189,33 @@ int RNG::uniformInt(int min, int max)
 void RNG::uniformSphere(float& x, float& y, float& z)
 {
     ensureSeeded();
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-    
-    // Use spherical coordinates with uniform distribution
-    float u = dist(s_generator);
-    float v = dist(s_generator);
-    
-    float theta = 2.0f * 3.14159265358979323846f * u;
-    float phi = std::acos(2.0f * v - 1.0f);
-    
-    x = std::sin(phi) * std::cos(theta);
-    y = std::sin(phi) * std::sin(theta);
-    z = std::cos(phi);
+    spherePoint(s_generator, x, y, z);
+}
+
+void RNG::uniformSphere(float* pXYZ, size_t nPoints)
+{
+    ensureSeeded();
+    std::mt19937_64& generator = s_generator;
+    for (size_t i = 0; i < nPoints; ++i)
+    {
+        spherePoint(generator, pXYZ[3 * i], pXYZ[3 * i + 1], pXYZ[3 * i + 2]);
+    }
+}
+
+void RNG::uniformDisk(float& x, float& y)
+{
+    ensureSeeded();
+    diskPoint(s_generator, x, y);
+}
+
+void RNG::uniformDisk(float* pXY, size_t nPoints)
+{
+    ensureSeeded();
+    std::mt19937_64& generator = s_generator;
+    for (size_t i = 0; i < nPoints; ++i)
+    {
+        diskPoint(generator, pXY[2 * i], pXY[2 * i + 1]);
+    }
 }
 
 float RNG::uniformAngle()
@@ -96,7 +228,88 @@ float RNG::uniformAngle()
 double RNG::normal(double mean, double stddev)
 {
     ensureSeeded();
-    std::normal_distribution<double> dist(mean, stddev);
-    return dist(s_generator);
+    return mean + stddev * zigguratNormal(s_generator);
+}
+
+void RNG::normal(double* pOut, size_t nValues, double mean, double stddev)
+{
+    ensureSeeded();
+    std::mt19937_64& generator = s_generator;
+    for (size_t i = 0; i < nValues; ++i)
+    {
+        pOut[i] = mean + stddev * zigguratNormal(generator);
+    }
+}
+
+double RNG::zigguratNormal(std::mt19937_64& generator)
+{
+    const ZigguratTables& tables = getZigguratTables();
+    for (;;)
+    {
+        // Low 7 bits pick the layer, top 53 bits give the signed position:
+        // the two never overlap, so layer and value are independent
+        uint64_t bits = generator();
+        int layer = (int)(bits & (ZIGGURAT_LAYERS - 1));
+        double u = (bits >> 11) * (2.0 * UNIT_53) - 1.0;
+
+        // Inside the rectangle fully covered by the density (~99% of draws)
+        if (std::abs(u) < tables.ratio[layer])
+        {
+            return u * tables.x[layer];
+        }
+        if (layer == 0)
+        {
+            return zigguratTail(generator, u < 0);
+        }
+
+        // Wedge between the rectangle and the density curve
+        double x = u * tables.x[layer];
+        double f0 = std::exp(-0.5 * (tables.x[layer] * tables.x[layer] - x * x));
+        double f1 = std::exp(-0.5 * (tables.x[layer + 1] * tables.x[layer + 1] - x * x));
+        if (f1 + openUnit01(generator) * (f0 - f1) < 1.0)
+        {
+            return x;
+        }
+    }
 }
 
+double RNG::zigguratTail(std::mt19937_64& generator, bool bNegative)
+{
+    // Marsaglia 1964: exact sampling of the normal tail beyond ZIGGURAT_R
+    double x, y;
+    do
+    {
+        x = std::log(openUnit01(generator)) / ZIGGURAT_R;
+        y = std::log(openUnit01(generator));
+    } while (-2.0 * y < x * x);
+    return bNegative ? x - ZIGGURAT_R : ZIGGURAT_R - x;
+}
+
+void RNG::diskPoint(std::mt19937_64& generator, float& x, float& y)
+{
+    // Rejection from the enclosing square accepts pi/4 of the candidates
+    float s;
+    do
+    {
+        x = signedUnit(generator);
+        y = signedUnit(generator);
+        s = x * x + y * y;
+    } while (s >= 1.0f);
+}
+
+void RNG::spherePoint(std::mt19937_64& generator, float& x, float& y, float& z)
+{
+    // Marsaglia 1972: map a uniform point (u, v) of the unit disk to the sphere
+    float u, v, s;
+    do
+    {
+        u = signedUnit(generator);
+        v = signedUnit(generator);
+        s = u * u + v * v;
+    } while (s >= 1.0f);
+
+    float scale = 2.0f * std::sqrt(1.0f - s);
+    x = u * scale;
+    y = v * scale;
+    z = 1.0f - 2.0f * s;
+}
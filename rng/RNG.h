@@ -2,6 +2,9 @@
 
 #include <random>
 #include <cstdint>
+#include <cstddef>
+
+namespace serialization { class BinarySerializer; }
 
 /**
  * Centralized random number generator for simulation.
@@ -38,6 +41,14 @@ public:
      */
     static double uniform01d();
     
+    /**
+     * Fill an array with uniform random doubles in [0, 1).
+     * 
+     * @param pOut Output array of nValues doubles
+     * @param nValues Number of values to generate
+     */
+    static void uniform01d(double* pOut, size_t nValues);
+    
     /**
      * Generate uniform random float in [min, max).
      */
@@ -56,9 +67,31 @@ public:
     /**
      * Generate random unit vector on sphere (uniform distribution).
      * Returns normalized (x, y, z) components.
+     * Uses Marsaglia's rejection method - no trigonometric functions.
      */
     static void uniformSphere(float& x, float& y, float& z);
     
+    /**
+     * Generate nPoints random unit vectors on sphere.
+     * 
+     * @param pXYZ Output array of 3 * nPoints floats, interleaved (x, y, z)
+     * @param nPoints Number of vectors to generate
+     */
+    static void uniformSphere(float* pXYZ, size_t nPoints);
+    
+    /**
+     * Generate random point uniformly distributed inside the unit disk.
+     */
+    static void uniformDisk(float& x, float& y);
+    
+    /**
+     * Generate nPoints random points inside the unit disk.
+     * 
+     * @param pXY Output array of 2 * nPoints floats, interleaved (x, y)
+     * @param nPoints Number of points to generate
+     */
+    static void uniformDisk(float* pXY, size_t nPoints);
+    
     /**
      * Generate random angle in [0, 2π).
      */
@@ -71,6 +104,25 @@ public:
      * @param stddev Standard deviation
      */
     static double normal(double mean, double stddev);
+    
+    /**
+     * Fill an array with values from normal distribution.
+     * 
+     * @param pOut Output array of nValues doubles
+     * @param nValues Number of values to generate
+     * @param mean Mean of the distribution
+     * @param stddev Standard deviation
+     */
+    static void normal(double* pOut, size_t nValues, double mean, double stddev);
+    
+    /**
+     * Save or restore the calling thread's generator state, so a long run can be
+     * checkpointed and resumed mid-stream. Direction depends on the serializer mode.
+     * 
+     * @return false on I/O error, unknown format version or corrupted state
+     *         (on restore the current state is then left unchanged)
+     */
+    static bool serializeState(serialization::BinarySerializer& serializer);
 
 private:
     static thread_local std::mt19937_64 s_generator;
@@ -80,5 +132,14 @@ private:
     
     // Ensure generator is seeded before use
     static void ensureSeeded();
+    
+    // Standard normal sample using the ziggurat method (Marsaglia & Tsang 2000,
+    // with Doornik's 2005 fix of the layer/value correlation)
+    static double zigguratNormal(std::mt19937_64& generator);
+    static double zigguratTail(std::mt19937_64& generator, bool bNegative);
+    
+    // Trig-free rejection samplers for the unit disk and the unit sphere
+    static void diskPoint(std::mt19937_64& generator, float& x, float& y);
+    static void spherePoint(std::mt19937_64& generator, float& x, float& y, float& z);
 };
 
@@ -0,0 +1,363 @@
+#include "RNGBenchmark.h"
+#include "RNG.h"
+#include "RNGSobol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+constexpr uint64_t QUALITY_SEED = 0x5EED5EED;
+constexpr double PASS_P_VALUE = 1e-4;         // two-sided: fail if p < 1e-4 or p > 1 - 1e-4
+constexpr size_t CHI_SQUARE_BUCKETS = 256;
+constexpr uint32_t BIRTHDAY_DAYS_LOG2 = 20;   // "year" of 2^20 days
+constexpr size_t BIRTHDAY_COUNT = 128;        // birthdays per trial: lambda = m^3 / (4n) = 0.5
+constexpr size_t BATCH_SIZE = 1024;
+
+// ---- sources: each fills a stream that is uniform in [0, 1) if the method is correct ----
+
+double normalCdf(double x)
+{
+    return 0.5 * std::erfc(-x / std::numbers::sqrt2);
+}
+
+void fillUniform01(std::vector<double>& v)
+{
+    for (double& x : v) x = RNG::uniform01();
+}
+void fillUniform01d(std::vector<double>& v)
+{
+    for (double& x : v) x = RNG::uniform01d();
+}
+void fillUniform01dBatch(std::vector<double>& v)
+{
+    RNG::uniform01d(v.data(), v.size());
+}
+void fillUniformFloat(std::vector<double>& v)
+{
+    for (double& x : v) x = (RNG::uniformFloat(-2.0f, 6.0f) + 2.0) / 8.0;
+}
+void fillUniformDouble(std::vector<double>& v)
+{
+    for (double& x : v) x = (RNG::uniformDouble(-2.0, 6.0) + 2.0) / 8.0;
+}
+void fillUniformInt(std::vector<double>& v)
+{
+    for (double& x : v) x = RNG::uniformInt(0, INT_MAX) / (double)INT_MAX;
+}
+void fillUniformAngle(std::vector<double>& v)
+{
+    for (double& x : v) x = RNG::uniformAngle() / (2.0 * std::numbers::pi);
+}
+void fillNormal(std::vector<double>& v)
+{
+    for (double& x : v) x = normalCdf((RNG::normal(3.0, 2.0) - 3.0) / 2.0);
+}
+void fillNormalBatch(std::vector<double>& v)
+{
+    RNG::normal(v.data(), v.size(), 0.0, 1.0);
+    for (double& x : v) x = normalCdf(x);
+}
+// Archimedes: the z-coordinate of a uniform point on the sphere is uniform in [-1, 1]
+void fillUniformSphere(std::vector<double>& v)
+{
+    float x, y, z;
+    for (double& u : v)
+    {
+        RNG::uniformSphere(x, y, z);
+        u = (z + 1.0) / 2.0;
+    }
+}
+void fillUniformSphereBatch(std::vector<double>& v)
+{
+    std::vector<float> xyz(3 * v.size());
+    RNG::uniformSphere(xyz.data(), v.size());
+    for (size_t i = 0; i < v.size(); ++i) v[i] = (xyz[3 * i + 2] + 1.0) / 2.0;
+}
+// squared radius of a uniform point in the unit disk is uniform in [0, 1)
+void fillUniformDisk(std::vector<double>& v)
+{
+    float x, y;
+    for (double& u : v)
+    {
+        RNG::uniformDisk(x, y);
+        u = (double)x * x + (double)y * y;
+    }
+}
+void fillUniformDiskBatch(std::vector<double>& v)
+{
+    std::vector<float> xy(2 * v.size());
+    RNG::uniformDisk(xy.data(), v.size());
+    for (size_t i = 0; i < v.size(); ++i) v[i] = (double)xy[2 * i] * xy[2 * i] + (double)xy[2 * i + 1] * xy[2 * i + 1];
+}
+
+struct SourceEntry { void (*fill)(std::vector<double>&); const char* name; };
+const SourceEntry SOURCES[] = {
+    { fillUniform01,           "uniform01" },
+    { fillUniform01d,          "uniform01d" },
+    { fillUniform01dBatch,     "uniform01d[batch]" },
+    { fillUniformFloat,        "uniformFloat" },
+    { fillUniformDouble,       "uniformDouble" },
+    { fillUniformInt,          "uniformInt" },
+    { fillUniformAngle,        "uniformAngle" },
+    { fillNormal,              "normal" },
+    { fillNormalBatch,         "normal[batch]" },
+    { fillUniformSphere,       "uniformSphere" },
+    { fillUniformSphereBatch,  "uniformSphere[batch]" },
+    { fillUniformDisk,         "uniformDisk" },
+    { fillUniformDiskBatch,    "uniformDisk[batch]" },
+};
+
+// ---- statistical tests: each returns a p-value ----
+
+// upper tail of chi-square with k degrees of freedom (Wilson-Hilferty approximation)
+double chiSquareUpperTail(double fChi2, double k)
+{
+    double fVar = 2.0 / (9.0 * k);
+    double z = (std::cbrt(fChi2 / k) - (1.0 - fVar)) / std::sqrt(fVar);
+    return 0.5 * std::erfc(z / std::numbers::sqrt2);
+}
+
+// upper tail of the standard normal distribution
+double normalUpperTail(double z)
+{
+    return 0.5 * std::erfc(z / std::numbers::sqrt2);
+}
+
+double testChiSquare(const std::vector<double>& v)
+{
+    std::vector<size_t> counts(CHI_SQUARE_BUCKETS, 0);
+    for (double x : v)
+    {
+        ++counts[std::min((size_t)(x * CHI_SQUARE_BUCKETS), CHI_SQUARE_BUCKETS - 1)];
+    }
+    double fExpected = (double)v.size() / CHI_SQUARE_BUCKETS;
+    double fChi2 = 0.0;
+    for (size_t c : counts)
+    {
+        fChi2 += (c - fExpected) * (c - fExpected) / fExpected;
+    }
+    return chiSquareUpperTail(fChi2, CHI_SQUARE_BUCKETS - 1);
+}
+
+// lag-1 correlation r: r * sqrt(n) is asymptotically standard normal
+double testSerialCorrelation(const std::vector<double>& v)
+{
+    size_t n = v.size() - 1;
+    double sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        double x = v[i], y = v[i + 1];
+        sx += x; sy += y; sxx += x * x; syy += y * y; sxy += x * y;
+    }
+    double fCov = sxy - sx * sy / n;
+    double fR = fCov / std::sqrt((sxx - sx * sx / n) * (syy - sy * sy / n));
+    return normalUpperTail(fR * std::sqrt((double)n));
+}
+
+// Marsaglia's birthday spacings: the number of repeated spacings between sorted
+// birthdays is Poisson(m^3 / 4n); the total over all trials is compared to its mean
+double testBirthdaySpacings(const std::vector<double>& v)
+{
+    const double fDays = (double)(1u << BIRTHDAY_DAYS_LOG2);
+    size_t nTrials = v.size() / BIRTHDAY_COUNT;
+    std::vector<uint32_t> days(BIRTHDAY_COUNT), spacings(BIRTHDAY_COUNT);
+    double fRepeats = 0.0;
+    for (size_t t = 0; t < nTrials; ++t)
+    {
+        for (size_t i = 0; i < BIRTHDAY_COUNT; ++i)
+        {
+            days[i] = (uint32_t)(v[t * BIRTHDAY_COUNT + i] * fDays);
+        }
+        std::sort(days.begin(), days.end());
+        spacings[0] = days[0];
+        for (size_t i = 1; i < BIRTHDAY_COUNT; ++i)
+        {
+            spacings[i] = days[i] - days[i - 1];
+        }
+        std::sort(spacings.begin(), spacings.end());
+        for (size_t i = 1; i < BIRTHDAY_COUNT; ++i)
+        {
+            if (spacings[i] == spacings[i - 1]) fRepeats += 1.0;
+        }
+    }
+    double m = BIRTHDAY_COUNT;
+    double fMean = nTrials * m * m * m / (4.0 * fDays);
+    return normalUpperTail((fRepeats - fMean) / std::sqrt(fMean));
+}
+
+struct TestEntry { double (*fn)(const std::vector<double>&); const char* name; };
+const TestEntry TESTS[] = {
+    { testChiSquare,          "chi_square" },
+    { testSerialCorrelation,  "serial_correlation" },
+    { testBirthdaySpacings,   "birthday_spacings" },
+};
+
+// ---- throughput ----
+
+volatile double g_fSink; // keeps the measured loops from being optimized away
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Each timed function calls one RNG method nValues times (or once for nValues
+// values) and returns a checksum; unlike the quality sources no mapping is applied
+double timeUniform01(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::uniform01(); return s; }
+double timeUniform01d(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::uniform01d(); return s; }
+double timeUniformFloat(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::uniformFloat(-2.0f, 6.0f); return s; }
+double timeUniformDouble(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::uniformDouble(-2.0, 6.0); return s; }
+double timeUniformInt(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::uniformInt(0, INT_MAX); return s; }
+double timeUniformAngle(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::uniformAngle(); return s; }
+double timeNormal(size_t n) { double s = 0; for (size_t i = 0; i < n; ++i) s += RNG::normal(0.0, 1.0); return s; }
+double timeUniformSphere(size_t n)
+{
+    float x, y, z, s = 0;
+    for (size_t i = 0; i < n; ++i) { RNG::uniformSphere(x, y, z); s += z; }
+    return s;
+}
+double timeUniformDisk(size_t n)
+{
+    float x, y, s = 0;
+    for (size_t i = 0; i < n; ++i) { RNG::uniformDisk(x, y); s += x; }
+    return s;
+}
+double timeUniform01dBatch(size_t n)
+{
+    std::vector<double> v(BATCH_SIZE);
+    for (size_t i = 0; i < n; i += BATCH_SIZE) RNG::uniform01d(v.data(), BATCH_SIZE);
+    return v[0];
+}
+double timeNormalBatch(size_t n)
+{
+    std::vector<double> v(BATCH_SIZE);
+    for (size_t i = 0; i < n; i += BATCH_SIZE) RNG::normal(v.data(), BATCH_SIZE, 0.0, 1.0);
+    return v[0];
+}
+double timeUniformSphereBatch(size_t n)
+{
+    std::vector<float> v(3 * BATCH_SIZE);
+    for (size_t i = 0; i < n; i += BATCH_SIZE) RNG::uniformSphere(v.data(), BATCH_SIZE);
+    return v[0];
+}
+double timeUniformDiskBatch(size_t n)
+{
+    std::vector<float> v(2 * BATCH_SIZE);
+    for (size_t i = 0; i < n; i += BATCH_SIZE) RNG::uniformDisk(v.data(), BATCH_SIZE);
+    return v[0];
+}
+
+struct TimedEntry { double (*fn)(size_t); const char* name; };
+const TimedEntry TIMED[] = {
+    { timeUniform01,           "uniform01" },
+    { timeUniform01d,          "uniform01d" },
+    { timeUniform01dBatch,     "uniform01d[batch]" },
+    { timeUniformFloat,        "uniformFloat" },
+    { timeUniformDouble,       "uniformDouble" },
+    { timeUniformInt,          "uniformInt" },
+    { timeUniformAngle,        "uniformAngle" },
+    { timeNormal,              "normal" },
+    { timeNormalBatch,         "normal[batch]" },
+    { timeUniformSphere,       "uniformSphere" },
+    { timeUniformSphereBatch,  "uniformSphere[batch]" },
+    { timeUniformDisk,         "uniformDisk" },
+    { timeUniformDiskBatch,    "uniformDisk[batch]" },
+};
+
+RNGThroughput measureMethod(const TimedEntry& entry, size_t nValues)
+{
+    // batched entries round up to whole batches
+    nValues = (nValues + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE;
+    auto start = std::chrono::steady_clock::now();
+    g_fSink = entry.fn(nValues);
+    return { entry.name, nValues / secondsSince(start) };
+}
+
+RNGThroughput measureSobolScalar(unsigned nDims, size_t nValues)
+{
+    RNGSobol sobol(nDims);
+    double fSum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nValues; ++i)
+    {
+        fSum += sobol.generate01();
+    }
+    double fSec = secondsSince(start);
+    g_fSink = fSum;
+    return { "RNGSobol::generate01[d=" + std::to_string(nDims) + "]", nValues / fSec };
+}
+
+RNGThroughput measureSobolBatch(unsigned nDims, size_t nValues)
+{
+    RNGSobol sobol(nDims);
+    unsigned nPoints = (unsigned)std::max<size_t>(1, nValues / nDims);
+    std::vector<double> points((size_t)nPoints * nDims);
+    auto start = std::chrono::steady_clock::now();
+    sobol.generatePoints(2048, nPoints, nDims, points.data());
+    double fSec = secondsSince(start);
+    g_fSink = points.back();
+    return { "RNGSobol::generatePoints[d=" + std::to_string(nDims) + "]", points.size() / fSec };
+}
+
+} // namespace
+
+std::vector<RNGThroughput> RNGBenchmark::measureThroughput(size_t nValues)
+{
+    std::vector<RNGThroughput> results;
+    for (const TimedEntry& entry : TIMED)
+    {
+        results.push_back(measureMethod(entry, nValues));
+    }
+    const unsigned SOBOL_DIMS[] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+    for (unsigned nDims : SOBOL_DIMS)
+    {
+        results.push_back(measureSobolScalar(nDims, nValues));
+        results.push_back(measureSobolBatch(nDims, nValues));
+    }
+    return results;
+}
+
+std::vector<RNGQualityResult> RNGBenchmark::runQualityTests(size_t nValues)
+{
+    RNG::seed(QUALITY_SEED);
+    std::vector<RNGQualityResult> results;
+    std::vector<double> values(nValues);
+    for (const SourceEntry& source : SOURCES)
+    {
+        source.fill(values);
+        for (const TestEntry& test : TESTS)
+        {
+            RNGQualityResult result;
+            result.sSource = source.name;
+            result.sTest = test.name;
+            result.fPValue = test.fn(values);
+            result.bPassed = result.fPValue > PASS_P_VALUE && result.fPValue < 1.0 - PASS_P_VALUE;
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+bool RNGBenchmark::run(std::ostream& out)
+{
+    out << "RNG throughput (values/sec):\n";
+    for (const RNGThroughput& result : measureThroughput())
+    {
+        out << "  " << result.sName << ": " << result.fValuesPerSec << "\n";
+    }
+
+    bool bAllPassed = true;
+    out << "RNG quality (p-values):\n";
+    for (const RNGQualityResult& result : runQualityTests())
+    {
+        out << "  " << result.sSource << " " << result.sTest << ": " << result.fPValue
+            << (result.bPassed ? "" : "  FAILED") << "\n";
+        bAllPassed = bAllPassed && result.bPassed;
+    }
+    out << (bAllPassed ? "RNG: all quality tests passed.\n" : "RNG: quality tests FAILED.\n");
+    return bAllPassed;
+}
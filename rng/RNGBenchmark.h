@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct RNGThroughput
+{
+    std::string sName;
+    double fValuesPerSec = 0.0;
+};
+
+struct RNGQualityResult
+{
+    std::string sSource;    // generator method under test
+    std::string sTest;      // chi_square, serial_correlation or birthday_spacings
+    double fPValue = 0.0;
+    bool bPassed = false;
+};
+
+/**
+ * Throughput and statistical-quality measurement of the generators in rng/.
+ * 
+ * Every RNG method (scalar and batched) is mapped to a stream of values that is
+ * uniform in [0, 1) if the method is correct (e.g. normal samples through the
+ * normal CDF, sphere z-coordinates by Archimedes' theorem), and the stream is run
+ * through a quick battery:
+ *   - chi-square over equal-width buckets (uniformity)
+ *   - lag-1 serial correlation (independence of neighbours)
+ *   - birthday spacings, Marsaglia 1984 (lattice structure in the low bits)
+ * 
+ * Usage:
+ *   bool bPassed = RNGBenchmark::run(std::cout);  // reseeds RNG
+ */
+class RNGBenchmark
+{
+public:
+    /**
+     * Values per second of every RNG method, and of RNGSobol per number of dimensions.
+     * 
+     * @param nValues Values generated per measurement
+     */
+    static std::vector<RNGThroughput> measureThroughput(size_t nValues = 1 << 22);
+
+    /**
+     * Run the statistical battery on every RNG method. Reseeds RNG with a fixed
+     * seed so the outcome is reproducible.
+     * 
+     * @param nValues Values drawn per source
+     */
+    static std::vector<RNGQualityResult> runQualityTests(size_t nValues = 1 << 20);
+
+    /**
+     * Measure throughput, run the quality tests and write a report to out.
+     * 
+     * @return true if all quality tests passed
+     */
+    static bool run(std::ostream& out);
+};
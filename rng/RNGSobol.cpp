@@ -1,210 +1,156 @@
-#include <intrin.h>
-#include <string.h>
+#include <bit>
 #include "RNGSobol.h"
+#include "BitMix.h"
+#include "utils/serialization/BinarySerializer.h"
 
-unsigned __int64 RNGSobol::cjn[QRNG_NDMS][63] = { 0 }; ///< used for random numbers generation
+// Binary state format: magic sentinel, then version
+static const uint32_t STATE_MAGIC = 0x4C424F53; // "SOBL"
+static const uint32_t STATE_VERSION = 1;
 
-RNGSobol::RNGSobol()
+RNGSobol::RNGSobol(unsigned nDims)
 {
-    if (cjn[0][0] != 0x4000000000000000)
+    assert(nDims > 0 && nDims <= SobolDirectionNumbers::getMaxDims());
+    m_nDims = nDims;
+    m_directions.resize((size_t)nDims * INDEX_BITS);
+    for (unsigned uDim = 0; uDim < nDims; ++uDim)
     {
-        GenerateCJ();
+        if (!SobolDirectionNumbers::computeDirections(uDim, &m_directions[(size_t)uDim * INDEX_BITS]))
+        {
+            m_nDims = uDim; // direction numbers exhausted
+            break;
+        }
     }
-    memset(this, 0, sizeof(*this));
+    m_prev.assign(m_nDims, DimState{ 0, 0 });
+    m_dimScrambleSeeds.assign(m_nDims, 0);
+    m_uCurDim = 0;
     m_uCurSeed = 2048;
     updateUValue();
     updateDValue();
 }
-void RNGSobol::updateUValue()
+void RNGSobol::setScrambleSeed(uint64_t uScrambleSeed)
 {
-    unsigned grayCode = (m_uCurSeed >> 1) ^ m_uCurSeed;
-    unsigned changedBits = m_prev[m_uCurDim].uPrevSeed ^ grayCode;
-    m_prev[m_uCurDim].uPrevSeed = grayCode;
-    unsigned long uBit;
-    while (_BitScanForward(&uBit, changedBits))
+    m_uScrambleSeed = uScrambleSeed;
+    m_bScrambled = true;
+    computeScrambleSeeds();
+    updateDValue();
+}
+void RNGSobol::computeScrambleSeeds()
+{
+    for (unsigned uDim = 0; uDim < m_nDims; ++uDim)
     {
-        m_prev[m_uCurDim].uValue ^= RNGSobol::cjn[m_uCurDim][uBit];
-        changedBits &= ~(1 << uBit);
+        m_dimScrambleSeeds[uDim] = (uint32_t)mix64(m_uScrambleSeed + 0x9E3779B97F4A7C15ULL * (uDim + 1));
     }
 }
-int RNGSobol::GeneratePolynomials(int buffer[QRNG_NDMS], bool primitive)
+bool RNGSobol::serializeState(serialization::BinarySerializer& serializer)
 {
-    int i, j, n, p1, p2, l;
-    int e_p1, e_p2, e_b;
-
-    // generate all polynomials to buffer
-    for (n = 1, buffer[0] = 0x2, p2 = 0, l = 0; n < QRNG_NDMS; ++n)
+    if (!serializer.serializeSentinel(STATE_MAGIC))
     {
-        // search for the next irreducable polynomial
-        for (p1 = buffer[n - 1] + 1;; ++p1)
-        {
-            // find degree of polynomial p1
-            for (e_p1 = 30; (p1 & (1 << e_p1)) == 0; --e_p1);
-
-            // try to divide p1 by all polynomials in buffer
-            for (i = 0; i < n; ++i)
-            {
-                // find the degree of buffer[i]
-                for (e_b = e_p1; (buffer[i] & (1 << e_b)) == 0; --e_b);
+        return false;
+    }
+    uint32_t uVersion = STATE_VERSION, nDims = m_nDims;
+    serializer.serialize(uVersion);
+    serializer.serialize(nDims);
+    if (!serializer.good() || uVersion != STATE_VERSION || nDims != m_nDims)
+    {
+        return false;
+    }
 
-                // divide p2 by buffer[i] until the end
-                for (p2 = (buffer[i] << ((e_p2 = e_p1) - e_b)) ^ p1; p2 >= buffer[i]; p2 = (buffer[i] << (e_p2 - e_b)) ^ p2)
-                {
-                    for (; (p2 & (1 << e_p2)) == 0; --e_p2);
-                } // compute new degree of p2
+    // work on copies so a failed restore leaves this generator untouched
+    std::vector<DimState> prev = m_prev;
+    uint32_t uCurSeed = m_uCurSeed, uCurDim = m_uCurDim, uRenormalizationProduct = m_uRenormalizationProduct;
+    double fRenormalizedValue = m_fRenormalizedValue;
+    uint8_t bScrambled = m_bScrambled ? 1 : 0;
+    uint64_t uScrambleSeed = m_uScrambleSeed;
+    serializer.serialize(uCurSeed);
+    serializer.serialize(uCurDim);
+    serializer.serialize(uRenormalizationProduct);
+    serializer.serialize(fRenormalizedValue);
+    serializer.serialize(bScrambled);
+    serializer.serialize(uScrambleSeed);
+    for (DimState& state : prev)
+    {
+        serializer.serialize(state.uValue);
+        serializer.serialize(state.uPrevSeed);
+    }
+    if (!serializer.good() || uCurDim >= m_nDims)
+    {
+        return false;
+    }
 
-                // division without remainder!!! p1 is not irreducable
-                if (p2 == 0)
-                {
-                    break;
-                }
-            }
-            // all divisions were with remainder - p1 is irreducable
-            if (p2 != 0)
-            {
-                e_p2 = 0;
-                if (primitive)
-                {
-                    // check that p1 has only one cycle (i.e. is monic, or primitive)
-                    j = ~(0xffffffff << (e_p1 + 1));
-                    e_b = (1 << e_p1) | 0x1;
-                    for (p2 = e_b, e_p2 = (1 << e_p1) - 2; e_p2 > 0; --e_p2)
-                    {
-                        p2 <<= 1;
-                        i = p2 & p1;
-                        i = (i & 0x55555555) + ((i >> 1) & 0x55555555);
-                        i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
-                        i = (i & 0x07070707) + ((i >> 4) & 0x07070707);
-                        p2 |= (i % 255) & 1;
-                        if ((p2 & j) == e_b) break;
-                    }
-                }
-                // it is monic - add it to the list of polynomials
-                if (e_p2 == 0)
-                {
-                    buffer[n] = p1;
-                    l += e_p1;
-                    break;
-                }
-            }
-        }
+    if (serializer.isReading())
+    {
+        m_prev = std::move(prev);
+        m_uCurSeed = uCurSeed;
+        m_uCurDim = uCurDim;
+        m_uRenormalizationProduct = uRenormalizationProduct;
+        m_fRenormalizedValue = fRenormalizedValue;
+        m_bScrambled = bScrambled != 0;
+        m_uScrambleSeed = uScrambleSeed;
+        computeScrambleSeeds();
     }
-    return l + 1;
+    return true;
 }
-
-//  @misc{Bratley92:LDS,
-//    author = "B. Fox and P. Bratley and H. Niederreiter",
-//    title = "Implementation and test of low discrepancy sequences",
-//    text = "B. L. Fox, P. Bratley, and H. Niederreiter. Implementation and test of
-//      low discrepancy sequences. ACM Trans. Model. Comput. Simul., 2(3):195--213,
-//      July 1992.",
-//    year = "1992" }
-void RNGSobol::GenerateCJ()
+void RNGSobol::updateUValue()
 {
-    int buffer[QRNG_NDMS];
-    int *polynomials;
-    int n, p1, l, e_p1;
-
-    // Niederreiter (in contrast to Sobol) allows to use not primitive, but just irreducable polynomials
-    l = GeneratePolynomials(buffer, false);
-
-    // convert all polynomials from buffer to polynomials table
-    polynomials = new int[l + 2 * QRNG_NDMS + 1];
-    for (n = 0, l = 0; n < QRNG_NDMS; ++n)
+    unsigned grayCode = (m_uCurSeed >> 1) ^ m_uCurSeed;
+    unsigned changedBits = m_prev[m_uCurDim].uPrevSeed ^ grayCode;
+    m_prev[m_uCurDim].uPrevSeed = grayCode;
+    const uint64_t* pDirections = &m_directions[(size_t)m_uCurDim * INDEX_BITS];
+    while (changedBits != 0)
     {
-        // find degree of polynomial p1
-        for (p1 = buffer[n], e_p1 = 30; (p1 & (1 << e_p1)) == 0; --e_p1);
-
-        // fill polynomials table with values for this polynomial
-        polynomials[l++] = 1;
-        for (--e_p1; e_p1 >= 0; --e_p1)
-        {
-            polynomials[l++] = (p1 >> e_p1) & 1;
-        }
-        polynomials[l++] = -1;
+        m_prev[m_uCurDim].uValue ^= pDirections[std::countr_zero(changedBits)];
+        changedBits &= changedBits - 1;
+    }
+}
+void RNGSobol::generatePoints(unsigned uStartIndex, unsigned nPoints, unsigned nDims, double* pOut) const
+{
+    assert(nDims <= m_nDims);
+    assert(nPoints == 0 || uStartIndex + (nPoints - 1) >= uStartIndex); // index must not wrap
+    if (nPoints == 0)
+    {
+        return;
     }
-    polynomials[l] = -1;
-
-    // irreducable polynomial p
-    int *p = polynomials, e, d;
-    // polynomial b
-    int b_arr[1024], *b, m;
-    // v array
-    int v_arr[1024], *v;
-    // temporary polynomial, required to do multiplication of p and b
-    int t_arr[1024], *t;
-    // subsidiary variables
-    int i, j, u, m1, ip, it;
 
-    // cycle over monic irreducible polynomials
-    for (d = 0; p[0] != -1; p += e + 2)
+    // skip-ahead: the first vector is the xor of the directions selected by its Gray code
+    std::vector<uint64_t> values(nDims, 0);
+    unsigned grayCode = (uStartIndex >> 1) ^ uStartIndex;
+    for (unsigned uDim = 0; uDim < nDims; ++uDim)
     {
-        // allocate memory for cj array for dimention (ip + 1)
-        for (i = 0; i < 63; ++i)
+        const uint64_t* pDirections = &m_directions[(size_t)uDim * INDEX_BITS];
+        for (unsigned uBits = grayCode; uBits != 0; uBits &= uBits - 1)
         {
-            RNGSobol::cjn[d][i] = 0;
+            values[uDim] ^= pDirections[std::countr_zero(uBits)];
         }
+        pOut[uDim] = toUnit01(values[uDim], uDim);
+    }
 
-        // determine the power of irreducable polynomial
-        for (e = 0; p[e + 1] != -1; ++e);
-        // polynomial b in the beginning is just '1'
-        (b = b_arr + 1023)[m = 0] = 1;
-        // v array needs only (63 + e - 2) length
-        v = v_arr + 1023 - (63 + e - 2);
-
-        // cycle over all coefficients
-        for (j = 63 - 1, u = e; j >= 0; --j, ++u)
+    // consecutive Gray codes differ in one bit: the lowest set bit of the new index
+    for (unsigned i = 1; i < nPoints; ++i)
+    {
+        unsigned uBit = std::countr_zero(uStartIndex + i);
+        double* pRow = pOut + (size_t)i * nDims;
+        for (unsigned uDim = 0; uDim < nDims; ++uDim)
         {
-            if (u == e)
-            {
-                u = 0;
-                // multiply b by p (polynomials multiplication)
-                for (i = 0, t = t_arr + 1023 - (m1 = m); i <= m; ++i)
-                {
-                    t[i] = b[i];
-                }
-                b = b_arr + 1023 - (m += e);
-
-                for (i = 0; i <= m; ++i)
-                {
-                    b[i] = 0;
-                    for (ip = e - (m - i), it = m1; ip <= e && it >= 0; ++ip, --it)
-                    {
-                        if (ip >= 0)
-                        {
-                            b[i] ^= p[ip] & t[it];
-                        }
-                    }
-                }
-                // multiplication of polynomials finished
-
-                // calculate v
-                for (i = 0; i < m1; ++i)
-                {
-                    v[i] = 0;
-                }
-                for (; i < m; ++i)
-                {
-                    v[i] = 1;
-                }
-                for (; i <= 63 + e - 2; ++i)
-                {
-                    v[i] = 0;
-                    for (it = 1; it <= m; ++it)
-                    {
-                        v[i] ^= v[i - it] & b[it];
-                    }
-                }
-            }
-
-            // copy calculated v to cj
-            for (i = 0; i < 63; ++i)
-            {
-                RNGSobol::cjn[d][i] |= (__int64)v[i + u] << j;
-            }
+            values[uDim] ^= m_directions[(size_t)uDim * INDEX_BITS + uBit];
+            pRow[uDim] = toUnit01(values[uDim], uDim);
         }
-        ++d;
     }
-
-    delete[]polynomials;
+}
+//  B. Burley, "Practical Hash-based Owen Scrambling", JCGT 9(4), 2020.
+// In bit-reversed order, adding the seed and xoring with a multiple by an even constant
+// only propagate changes towards higher bits - so every digit is flipped depending on
+// the digits above it only, which is nested uniform scrambling of the top 32 digits.
+// Digits below 2^-32 get a uniform jitter inside the elementary interval, which is what
+// full Owen scrambling produces for the first 2^32 points.
+uint64_t RNGSobol::owenScramble(uint64_t uValue, uint32_t uSeed)
+{
+    uint32_t uHigh = (uint32_t)(uValue >> 32);
+    uint32_t x = reverseBits32(uHigh);
+    x += uSeed;
+    x ^= x * 0x6C50B47Cu;
+    x ^= x * 0xB82F1E52u;
+    x ^= x * 0xC7AFE638u;
+    x ^= x * 0x8D22F6E6u;
+    uint64_t uLow = mix64(((uint64_t)uSeed << 32) | uHigh) >> 32;
+    return ((uint64_t)reverseBits32(x) << 32) | uLow;
 }
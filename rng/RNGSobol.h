@@ -2,21 +2,30 @@
 #define _RNG_SOBOL_HPP_
 
 #include <assert.h>
+#include <stdint.h>
+#include <vector>
+#include "SobolDirectionNumbers.h"
 
+namespace serialization { class BinarySerializer; }
+
+// Sobol sequence with Joe-Kuo direction numbers and optional Owen scrambling
 class RNGSobol
 {
 public:
-    static inline unsigned getNDims()
+    static const unsigned DEFAULT_NDIMS = 32;
+
+    inline unsigned getNDims() const
     {
-        return QRNG_NDMS;
+        return m_nDims;
     }
-    /// default constructor
-    RNGSobol();
+    /// nDims must not exceed SobolDirectionNumbers::getMaxDims()
+    explicit RNGSobol(unsigned nDims = DEFAULT_NDIMS);
     inline void prepareForIntegration(unsigned nDims)
     {
         setSeed(2048 + nDims * 1024);
     }
-    /// set current vector index
+    /// set current vector index - O(log uSeed): each dimension applies only the Gray-code
+    /// bits that differ from its previous index
     inline void setSeed(unsigned uSeed)
     {
         m_uCurSeed = uSeed;
@@ -31,10 +40,19 @@ public:
         updateUValue();
         updateDValue();
     }
+    /// jump nSteps vectors ahead without generating the vectors in between
+    inline void skipAhead(unsigned nSteps)
+    {
+        setSeed(m_uCurSeed + nSteps);
+    }
+    /// write vectors [uStartIndex, uStartIndex + nPoints) into pOut as a flat row-major
+    /// nPoints x nDims array. The current position is not changed, so threads can fill
+    /// disjoint index ranges of the same sequence from one shared instance.
+    void generatePoints(unsigned uStartIndex, unsigned nPoints, unsigned nDims, double* pOut) const;
     // set current dimension index
     inline void setDim(unsigned uDim)
     {
-        assert(uDim < QRNG_NDMS);
+        assert(uDim < m_nDims);
         m_uCurDim = uDim;
         updateUValue();
         updateDValue();
@@ -43,9 +61,9 @@ public:
     double generate01()
     {
         double fValue = m_fRenormalizedValue;
-        if (++m_uCurDim >= QRNG_NDMS)
+        if (++m_uCurDim >= m_nDims)
         {
-            assert(false); // probably something is wrong - why do you need such a high dimension?
+            // all dimensions of this vector consumed - continue with the next vector
             m_uCurDim = 0;
             ++m_uCurSeed;
         }
@@ -66,12 +84,28 @@ public:
         double fTmp = generate01();
         return fMin * (1 - fTmp) + fMax * fTmp;
     }
+    /// enable Owen (nested uniform) scrambling - each seed gives an independent
+    /// randomization that keeps the low-discrepancy structure
+    void setScrambleSeed(uint64_t uScrambleSeed);
+    inline void disableScrambling()
+    {
+        m_bScrambled = false;
+        updateDValue();
+    }
+    inline bool isScrambled() const
+    {
+        return m_bScrambled;
+    }
+    /// save or restore the position in the sequence and the scrambling state, depending
+    /// on the serializer mode. Restoring requires the same number of dimensions.
+    /// On failure returns false and leaves the current state unchanged.
+    bool serializeState(serialization::BinarySerializer& serializer);
 
 private:
     inline void updateDValue()
     {
         m_uRenormalizationProduct = 1;
-        m_fRenormalizedValue = m_prev[m_uCurDim].uValue / (double)MAX_INT64;
+        m_fRenormalizedValue = toUnit01(m_prev[m_uCurDim].uValue, m_uCurDim);
         assert(m_fRenormalizedValue >= 0 && m_fRenormalizedValue < 1);
     }
     inline unsigned getUValueAndRenormalize(unsigned uMax)
@@ -81,7 +115,7 @@ private:
         m_uRenormalizationProduct *= uMax;
         if (m_uRenormalizationProduct > RENORMALIZATION_POTENTIAL)
         {
-            if (++m_uCurDim >= QRNG_NDMS)
+            if (++m_uCurDim >= m_nDims)
             {
                 m_uCurDim = 0;
                 ++m_uCurSeed;
@@ -93,22 +127,32 @@ private:
         m_fRenormalizedValue -= uValue;
         return uValue;
     }
+    inline double toUnit01(uint64_t uValue, unsigned uDim) const
+    {
+        if (m_bScrambled)
+        {
+            uValue = owenScramble(uValue, m_dimScrambleSeeds[uDim]);
+        }
+        return (uValue >> 11) * UNIT_53;
+    }
     void updateUValue();
-    static const unsigned QRNG_NDMS = 32; // number of dimensions of sequence we're going to generate
+    void computeScrambleSeeds();
+    static uint64_t owenScramble(uint64_t uValue, uint32_t uSeed);
     static const unsigned RENORMALIZATION_POTENTIAL = 2048;
-    struct
+    static constexpr double UNIT_53 = 1.0 / 9007199254740992.0; // 2^-53
+    static const unsigned INDEX_BITS = SobolDirectionNumbers::INDEX_BITS;
+    struct DimState
     {
-        unsigned __int64 uValue;
+        uint64_t uValue;
         unsigned uPrevSeed;
-    } m_prev[QRNG_NDMS];
+    };
+    std::vector<DimState> m_prev;
+    std::vector<uint64_t> m_directions;         // INDEX_BITS direction numbers per dimension
+    std::vector<uint32_t> m_dimScrambleSeeds;   // per-dimension Owen scrambling seeds
+    bool m_bScrambled = false;
+    uint64_t m_uScrambleSeed = 0;
     double m_fRenormalizedValue;
-    unsigned m_uCurSeed, m_uCurDim, m_uRenormalizationProduct;
-
-    // static values used for quasi-random numbers generation
-    static unsigned __int64 cjn[QRNG_NDMS][63];
-    const static unsigned __int64 MAX_INT64 = 0x8000000000000000ULL;
-    static void GenerateCJ();
-    static int GeneratePolynomials(int buffer[QRNG_NDMS], bool primitive);
+    unsigned m_nDims, m_uCurSeed, m_uCurDim, m_uRenormalizationProduct;
 };
 
 #endif
@@ -0,0 +1,178 @@
+#include "SobolDirectionNumbers.h"
+#include <fstream>
+#include <sstream>
+
+// Built-in Joe-Kuo table, see SobolJoeKuoTable.cpp
+extern const unsigned JOE_KUO_TABLE_DIMS;
+extern const uint32_t JOE_KUO_POLYNOMIALS[];
+extern const uint16_t JOE_KUO_M[];
+
+std::mutex SobolDirectionNumbers::s_mutex;
+std::vector<uint32_t> SobolDirectionNumbers::s_loadedPolynomials;
+std::vector<uint32_t> SobolDirectionNumbers::s_loadedM;
+std::vector<size_t> SobolDirectionNumbers::s_loadedMOffsets;
+
+namespace {
+
+unsigned getPolynomialDegree(uint32_t uPolynomial)
+{
+    unsigned uDegree = 0;
+    while (uPolynomial >>= 1)
+    {
+        ++uDegree;
+    }
+    return uDegree;
+}
+
+std::vector<size_t> computeBuiltInOffsets()
+{
+    std::vector<size_t> offsets(JOE_KUO_TABLE_DIMS - 1);
+    size_t offset = 0;
+    for (unsigned i = 0; i + 1 < JOE_KUO_TABLE_DIMS; ++i)
+    {
+        offsets[i] = offset;
+        offset += getPolynomialDegree(JOE_KUO_POLYNOMIALS[i]);
+    }
+    return offsets;
+}
+
+// Start of each built-in dimension in JOE_KUO_M
+const std::vector<size_t>& getBuiltInOffsets()
+{
+    static const std::vector<size_t> s_offsets = computeBuiltInOffsets();
+    return s_offsets;
+}
+
+} // namespace
+
+bool SobolDirectionNumbers::loadJoeKuoFile(const std::string& sPath)
+{
+    std::ifstream file(sPath);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line))
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> polynomials;
+    std::vector<uint32_t> m;
+    std::vector<size_t> offsets;
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        unsigned d, s;
+        uint32_t a;
+        if (!(fields >> d >> s >> a))
+        {
+            continue; // blank line
+        }
+        // dimensions must be consecutive starting at 2; degree is limited by the index width
+        if (d != polynomials.size() + 2 || s == 0 || s >= INDEX_BITS || a >= (1u << (s - 1)))
+        {
+            return false;
+        }
+        offsets.push_back(m.size());
+        for (unsigned k = 1; k <= s; ++k)
+        {
+            uint32_t mk;
+            if (!(fields >> mk) || (mk & 1) == 0 || mk >= (1u << k))
+            {
+                return false;
+            }
+            m.push_back(mk);
+        }
+        polynomials.push_back((1u << s) | (a << 1) | 1u);
+    }
+    if (polynomials.empty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_loadedPolynomials = std::move(polynomials);
+    s_loadedM = std::move(m);
+    s_loadedMOffsets = std::move(offsets);
+    return true;
+}
+
+unsigned SobolDirectionNumbers::getMaxDims()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_loadedPolynomials.empty())
+    {
+        return (unsigned)s_loadedPolynomials.size() + 1;
+    }
+    return JOE_KUO_TABLE_DIMS;
+}
+
+bool SobolDirectionNumbers::computeDirections(unsigned uDim, uint64_t pDirections[INDEX_BITS])
+{
+    // first dimension is the van der Corput sequence: all m_k = 1
+    if (uDim == 0)
+    {
+        for (unsigned k = 0; k < INDEX_BITS; ++k)
+        {
+            pDirections[k] = 1ULL << (63 - k);
+        }
+        return true;
+    }
+
+    uint32_t pM[INDEX_BITS];
+    uint32_t uPolynomial;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!s_loadedPolynomials.empty())
+        {
+            if (uDim > s_loadedPolynomials.size())
+            {
+                return false;
+            }
+            uPolynomial = s_loadedPolynomials[uDim - 1];
+            const uint32_t* pSrc = &s_loadedM[s_loadedMOffsets[uDim - 1]];
+            for (unsigned k = 0; k < getPolynomialDegree(uPolynomial); ++k)
+            {
+                pM[k] = pSrc[k];
+            }
+        }
+        else
+        {
+            if (uDim >= JOE_KUO_TABLE_DIMS)
+            {
+                return false;
+            }
+            uPolynomial = JOE_KUO_POLYNOMIALS[uDim - 1];
+            const uint16_t* pSrc = &JOE_KUO_M[getBuiltInOffsets()[uDim - 1]];
+            for (unsigned k = 0; k < getPolynomialDegree(uPolynomial); ++k)
+            {
+                pM[k] = pSrc[k];
+            }
+        }
+    }
+    computeFromPolynomial(uPolynomial, pM, pDirections);
+    return true;
+}
+
+// Bratley & Fox 1988, algorithm 659: v_k = m_k / 2^k for k <= s, then the recurrence
+//   v_k = a_1 v_(k-1) ^ a_2 v_(k-2) ^ ... ^ a_(s-1) v_(k-s+1) ^ v_(k-s) ^ (v_(k-s) >> s)
+void SobolDirectionNumbers::computeFromPolynomial(uint32_t uPolynomial, const uint32_t* pM, uint64_t pDirections[INDEX_BITS])
+{
+    unsigned s = getPolynomialDegree(uPolynomial);
+    uint32_t a = (uPolynomial >> 1) & ((1u << (s - 1)) - 1);
+
+    for (unsigned k = 0; k < INDEX_BITS && k < s; ++k)
+    {
+        pDirections[k] = (uint64_t)pM[k] << (63 - k);
+    }
+    for (unsigned k = s; k < INDEX_BITS; ++k)
+    {
+        uint64_t v = pDirections[k - s] ^ (pDirections[k - s] >> s);
+        for (unsigned i = 1; i < s; ++i)
+        {
+            if ((a >> (s - 1 - i)) & 1)
+            {
+                v ^= pDirections[k - i];
+            }
+        }
+        pDirections[k] = v;
+    }
+}
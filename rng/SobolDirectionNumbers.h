@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Sobol direction numbers from the Joe-Kuo tables.
+ * 
+ * The first 4096 dimensions are built in. Higher dimensions (up to 21201) become
+ * available after loading the original new-joe-kuo-6.21201 file:
+ *   SobolDirectionNumbers::loadJoeKuoFile("new-joe-kuo-6.21201");
+ * 
+ * Direction numbers are 64-bit: bit k of the point index contributes
+ * pDirections[k], whose leading bit is 2^-(k+1) of the unit interval.
+ */
+class SobolDirectionNumbers
+{
+public:
+    static const unsigned INDEX_BITS = 32; // sequence index is a 32-bit unsigned
+
+    /**
+     * Load direction numbers in the Joe-Kuo text format ("d s a m_1 ... m_s" per line,
+     * one header line). Replaces the built-in table for all dimensions.
+     * 
+     * @return false if the file can't be read or is malformed (built-in table is kept)
+     */
+    static bool loadJoeKuoFile(const std::string& sPath);
+
+    /**
+     * Number of dimensions for which direction numbers are available.
+     */
+    static unsigned getMaxDims();
+
+    /**
+     * Compute INDEX_BITS direction numbers for the 0-based dimension uDim.
+     * 
+     * @return false if uDim >= getMaxDims()
+     */
+    static bool computeDirections(unsigned uDim, uint64_t pDirections[INDEX_BITS]);
+
+private:
+    // Primitive polynomial (degree s, coefficients a) and initial m_1..m_s of one dimension
+    static void computeFromPolynomial(uint32_t uPolynomial, const uint32_t* pM, uint64_t pDirections[INDEX_BITS]);
+
+    static std::mutex s_mutex;
+    static std::vector<uint32_t> s_loadedPolynomials; // dimension 2 onwards, empty if nothing loaded
+    static std::vector<uint32_t> s_loadedM;           // m values of all loaded dimensions, concatenated
+    static std::vector<size_t> s_loadedMOffsets;      // start of each dimension in s_loadedM
+};